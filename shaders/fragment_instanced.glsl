@@ -0,0 +1,13 @@
+#version 140
+
+in vec3 normal;
+in vec4 position_vs;
+in vec4 instance_color;
+
+void main(void)
+{
+	vec3 lightDir = normalize(vec3(0.0f,1.0f,0.0f));
+	float diff = max(dot(lightDir,normalize(normal)),0.0f);
+	gl_FragColor = instance_color * 0.3f + diff * instance_color;
+	
+}
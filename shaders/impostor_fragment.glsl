@@ -0,0 +1,17 @@
+#version 140
+
+in vec2 uv;
+
+uniform sampler2D sampler;
+
+void main()
+{
+    vec4 color = texture(sampler, uv);
+
+    // Outside the captured silhouette: the capture clears alpha to 0, while the shape
+    // shader writes at least its ambient term there
+    if (color.a < 0.1)
+        discard;
+
+    gl_FragColor = vec4(color.rgb, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 150
+
+in vec3 in_position;
+in vec2 in_uv;
+
+out vec2 uv;
+
+layout(std140) uniform Frame
+{
+	mat4 projection;
+	mat4 view;
+	mat4 view_projection;
+	vec4 viewport;
+	vec4 time;
+};
+
+void main()
+{
+    gl_Position = view_projection * vec4(in_position, 1.0);
+    uv = in_uv;
+}
\ No newline at end of file
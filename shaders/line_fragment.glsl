@@ -1,6 +1,8 @@
 #version 140
 
+in vec3 line_color;
+
 void main(void)
 {
-    gl_FragColor = vec4(1.0f);
+    gl_FragColor = vec4(line_color, 1.0f);
 }
\ No newline at end of file
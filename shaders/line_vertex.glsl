@@ -1,11 +1,21 @@
 #version 150
 
 in vec3 in_position;
+in vec3 in_color;
 
-uniform mat4 projection;
-uniform mat4 view;
+out vec3 line_color;
+
+layout(std140) uniform Frame
+{
+	mat4 projection;
+	mat4 view;
+	mat4 view_projection;
+	vec4 viewport;
+	vec4 time;
+};
 
 void main()
 {
-    gl_Position = projection * view * vec4(in_position,1.0);
+    gl_Position = view_projection * vec4(in_position,1.0);
+    line_color = in_color;
 }
\ No newline at end of file
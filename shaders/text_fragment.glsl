@@ -1,12 +1,11 @@
 #version 140
 
 in vec2 uv;
+in vec4 text_color;
 
 uniform sampler2D sampler;
 
-uniform vec4 color;
-
 void main()
 {
-    gl_FragColor = color * texture( sampler, uv );
+    gl_FragColor = text_color * texture( sampler, uv );
 }
\ No newline at end of file
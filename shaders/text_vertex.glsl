@@ -2,12 +2,15 @@
 
 in vec2 in_position;
 in vec2 in_uv;
+in vec4 in_color;
 
 out vec2 uv;
+out vec4 text_color;
 
 void main()
 {
 	gl_Position = vec4(in_position * 2 - 1, 0, 1);
 
     uv = in_uv;
+    text_color = in_color;
 }
\ No newline at end of file
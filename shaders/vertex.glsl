@@ -1,18 +1,29 @@
 #version 150
 
+// Either floats or, for compact meshes, half float positions and 10 bit signed
+// normalized normals; both reach the shader as floats, w defaulting to 1
 in vec4 in_position;
 in vec3 in_normal;
 
 out vec3 normal;
 out vec4 position_vs;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout(std140) uniform Frame
+{
+	mat4 projection;
+	mat4 view;
+	mat4 view_projection;
+	vec4 viewport;
+	vec4 time;
+};
+
 uniform mat4 model;
+// Inverse transpose of mat3(view * model), computed once per draw on the CPU
+uniform mat3 normal_matrix;
 
 void main()
 {
 	position_vs = view * model * in_position;
 	gl_Position = projection * position_vs;
-	normal = transpose(inverse(mat3(view * model))) * in_normal;
+	normal = normal_matrix * in_normal;
 }
@@ -0,0 +1,34 @@
+#version 150
+
+// Either floats or, for compact meshes, half float positions and 10 bit signed
+// normalized normals; both reach the shader as floats, w defaulting to 1
+in vec4 in_position;
+in vec3 in_normal;
+
+// Per instance
+in mat4 in_model;
+in vec4 in_color;
+// World space normal matrix, computed once per instance on the CPU
+in mat3 in_normal_matrix;
+
+out vec3 normal;
+out vec4 position_vs;
+out vec4 instance_color;
+
+layout(std140) uniform Frame
+{
+	mat4 projection;
+	mat4 view;
+	mat4 view_projection;
+	vec4 viewport;
+	vec4 time;
+};
+
+void main()
+{
+	position_vs = view * in_model * in_position;
+	gl_Position = projection * position_vs;
+	// The view is rigid, its rotation carries normals to view space unchanged
+	normal = mat3(view) * (in_normal_matrix * in_normal);
+	instance_color = in_color;
+}
@@ -0,0 +1,45 @@
+#version 150
+
+// Compact layout only: half float positions and 10 bit signed normalized normals,
+// reaching the shader as floats, w defaulting to 1
+in vec4 in_position;
+in vec3 in_normal;
+// Palette entry of the part the vertex belongs to
+in uint in_part;
+
+out vec3 normal;
+out vec4 position_vs;
+out vec4 instance_color;
+
+layout(std140) uniform Frame
+{
+	mat4 projection;
+	mat4 view;
+	mat4 view_projection;
+	vec4 viewport;
+	vec4 time;
+};
+
+// Same layout as the render queue's InstanceData
+struct Part
+{
+	mat4 model;
+	vec4 color;
+	// World space normal matrix, computed once per part on the CPU
+	mat3 normal_matrix;
+};
+
+// MODEL_MAX_PARTS entries, filled for the model being drawn
+layout(std140) uniform Palette
+{
+	Part parts[16];
+};
+
+void main()
+{
+	position_vs = view * parts[in_part].model * in_position;
+	gl_Position = projection * position_vs;
+	// The view is rigid, its rotation carries normals to view space unchanged
+	normal = mat3(view) * (parts[in_part].normal_matrix * in_normal);
+	instance_color = parts[in_part].color;
+}
@@ -0,0 +1,199 @@
+#include "bvh.h"
+#include <cfloat>
+
+const uint BoundingHierarchy::NONE;
+
+// Every primitive is modelled in this cube, see Node::boundaries
+static const AABB unit_cube = { vec3(-0.5f), vec3(0.5f) };
+
+BoundingHierarchy::BoundingHierarchy()
+	: _parts(), _revision(0)
+{ }
+
+void BoundingHierarchy::Build(Node* root)
+{
+	_parts.clear();
+	Add(root, NONE);
+	_boxes.resize(_parts.size());
+	_inverses.resize(_parts.size());
+
+	// Force a full fit on first use
+	for (Part& part : _parts)
+		part.version = part.node->TransformVersion() - 1;
+	_revision = root->TreeRevision() - 1;
+}
+
+void BoundingHierarchy::Add(Node* node, uint parent)
+{
+	uint index = _parts.size();
+	_parts.push_back(Part());
+	_parts[index].node = node;
+	_parts[index].parent = parent;
+	_parts[index].changed = false;
+
+	for (Node* child : node->children())
+		Add(child, index);
+
+	_parts[index].end = _parts.size();
+}
+
+void BoundingHierarchy::Refit()
+{
+	if (_parts.empty())
+		return;
+
+	// Flushes pending transforms of the model's tree; nothing to do if none of its matrices moved since
+	uint revision = _parts[0].node->TreeRevision();
+	if (revision == _revision)
+		return;
+	_revision = revision;
+
+	// Children follow their parent, so walking backwards refits bottom-up
+	for (uint i = _parts.size(); i-- > 0;)
+	{
+		Part& part = _parts[i];
+
+		uint version = part.node->TransformVersion();
+		if (version != part.version)
+		{
+			part.version = version;
+			_boxes[i] = part.node->GetFullBoundingBox();
+			_inverses[i] = inverse(part.node->GetWorldTransform());
+			part.changed = true;
+		}
+
+		if (!part.changed)
+			continue;
+
+		part.volume = _boxes[i];
+		for (uint child = i + 1; child < part.end; child = _parts[child].end)
+		{
+			part.volume.min = min(part.volume.min, _parts[child].volume.min);
+			part.volume.max = max(part.volume.max, _parts[child].volume.max);
+		}
+
+		if (part.parent != NONE)
+			_parts[part.parent].changed = true;
+		part.changed = false;
+	}
+}
+
+AABB BoundingHierarchy::GetBounds()
+{
+	Refit();
+	return _parts[0].volume;
+}
+
+uint BoundingHierarchy::GetPartBoxes(AABB* out, uint capacity)
+{
+	Refit();
+
+	uint count = _parts.size();
+	for (uint i = 0; i < count && i < capacity; ++i)
+		out[i] = _boxes[i];
+	return count;
+}
+
+bool BoundingHierarchy::Intersect(const vec3& world_pos)
+{
+	Refit();
+
+	uint i = 0;
+	while (i < _parts.size())
+	{
+		const Part& part = _parts[i];
+		if (!part.volume.Contains(world_pos))
+		{
+			// Skip the whole subtree
+			i = part.end;
+			continue;
+		}
+
+		if (_boxes[i].Contains(world_pos) && ContainsLocal(i, world_pos))
+			return true;
+		++i;
+	}
+
+	return false;
+}
+
+bool BoundingHierarchy::IntersectSegment(const vec3& from, const vec3& to, float& toi)
+{
+	Refit();
+
+	float best = FLT_MAX;
+	uint i = 0;
+	while (i < _parts.size())
+	{
+		const Part& part = _parts[i];
+
+		// Skip subtrees that are missed or can only be reached after the best hit so far
+		float t;
+		if (!part.volume.IntersectSegment(from, to, t) || t >= best)
+		{
+			i = part.end;
+			continue;
+		}
+
+		if (_boxes[i].IntersectSegment(from, to, t) && IntersectLocal(i, from, to, t) && t < best)
+			best = t;
+		++i;
+	}
+
+	if (best == FLT_MAX)
+		return false;
+
+	toi = best;
+	return true;
+}
+
+void BoundingHierarchy::IntersectSegments(const SegmentBatch& segments, std::vector<float>& toi)
+{
+	Refit();
+
+	toi.assign(segments.size(), FLT_MAX);
+	if (segments.size() == 0)
+		return;
+
+	// Nothing to do unless a segment reaches the model at all
+	segments.Intersect(&_parts[0].volume, 1, _masks);
+	bool any = false;
+	for (uint word : _masks)
+		any |= word != 0;
+	if (!any)
+		return;
+
+	segments.Intersect(_boxes.data(), _boxes.size(), _masks);
+
+	// Exact time of impact, only for the pairs flagged by the batch test
+	uint words = segments.MaskWords();
+	for (uint b = 0; b < _boxes.size(); ++b)
+	{
+		for (uint w = 0; w < words; ++w)
+		{
+			uint bits = _masks[b * words + w];
+			for (uint bit = 0; bits != 0; ++bit, bits >>= 1)
+			{
+				if (!(bits & 1))
+					continue;
+
+				uint i = w * 32 + bit;
+				float t;
+				if (IntersectLocal(b, segments.from(i), segments.to(i), t))
+					toi[i] = min(toi[i], t);
+			}
+		}
+	}
+}
+
+bool BoundingHierarchy::ContainsLocal(uint part, const vec3& world_pos) const
+{
+	return unit_cube.Contains(vec3(_inverses[part] * vec4(world_pos, 1)));
+}
+
+bool BoundingHierarchy::IntersectLocal(uint part, const vec3& from, const vec3& to, float& t) const
+{
+	// Affine transforms preserve the segment parameter, so t needs no conversion back
+	const mat4& inv = _inverses[part];
+	return unit_cube.IntersectSegment(vec3(inv * vec4(from, 1)), vec3(inv * vec4(to, 1)), t);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "scene.h"
+#include "segments.h"
+
+// Bounding volume hierarchy over the parts of a model.
+// It mirrors the node hierarchy: every entry bounds its own part and all of its
+// descendants. Boxes are kept between frames and refitted bottom-up, only for the
+// parts whose world transform changed since the last refit.
+// World boxes only cull; hits are confirmed exactly against each part's unit cube,
+// in local space, through the inverse world transform cached at refit time.
+class BoundingHierarchy
+{
+public:
+	BoundingHierarchy();
+
+	void Build(Node* root);
+	void Refit();
+
+	AABB GetBounds();
+	uint GetPartBoxes(AABB* out, uint capacity);
+	bool Intersect(const vec3& world_pos);
+	// Earliest part hit by the segment [from, to], as a fraction of the segment
+	bool IntersectSegment(const vec3& from, const vec3& to, float& toi);
+	// Batched version: toi[i] receives the earliest hit of segment i, or FLT_MAX on a miss
+	void IntersectSegments(const SegmentBatch& segments, std::vector<float>& toi);
+
+private:
+	static const uint NONE = UINT_MAX;
+
+	struct Part
+	{
+		Node* node;
+		uint parent;
+		uint end;      // One past the last descendant
+		uint version;  // Transform version the box was computed for
+		bool changed;
+		AABB volume;   // This part and its descendants
+	};
+
+	void Add(Node* node, uint parent);
+	bool ContainsLocal(uint part, const vec3& world_pos) const;
+	bool IntersectLocal(uint part, const vec3& from, const vec3& to, float& t) const;
+
+	std::vector<Part> _parts;
+	std::vector<AABB> _boxes;	// Each part alone, contiguous for batched tests
+	std::vector<mat4> _inverses;	// World to part space
+	std::vector<uint> _masks;
+	uint _revision;
+};
@@ -1,8 +1,12 @@
 #include "core.h"
 #include "scene.h"
+#include "render_queue.h"
+#include "gl_state.h"
+#include "shader_program.h"
+#include "stream_buffer.h"
 #include <iostream>
 
-Core::Core() : _window(nullptr), _textVertexBuffer(BAD_BUFFER), _textUVBuffer(BAD_BUFFER), _attribute_textPosition(4), _attribute_textUV(3), _width(768), _height(640)
+Core::Core() : _window(nullptr), _attribute_textPosition(4), _attribute_textUV(3), _attribute_textColor(5), _width(768), _height(640)
 {
 	GLFWInit();
 	GLEWInit();
@@ -10,10 +14,18 @@ Core::Core() : _window(nullptr), _textVertexBuffer(BAD_BUFFER), _textUVBuffer(BA
 	// Clear possible error from GLFW/GLEW initialization
 	glGetError();
 
+	// Lines, text and instances are all streamed through it
+	StreamBuffer::Instance().Initialize(STREAM_FRAME_SIZE);
+	// Every primitive mesh is stored in its buffers
+	MeshRegistry::Instance().Initialize();
+
 	TextInit();
-	LineInit();
+	DebugInit();
 
 	CoreInit();
+	InstancedInit();
+	FrameInit();
+	ImpostorInit();
 
 	_callback_object = this;
 
@@ -27,17 +39,24 @@ Core::Core() : _window(nullptr), _textVertexBuffer(BAD_BUFFER), _textUVBuffer(BA
 
 Core::~Core()
 {
-	glDeleteProgram(_shaderProgram);
-	glDeleteProgram(_textProgram);
+	// Every GL object goes before glfwTerminate destroys the context
+	_shaderProgram.Release();
+	_instancedProgram.Release();
+	_modelProgram.Release();
+	_textProgram.Release();
 
-	if (_textVertexBuffer != BAD_BUFFER)
-		glDeleteBuffers(1, &_textVertexBuffer);
+	dd::shutdown();
+	_debugDraw.Release();
+	_impostors.Release();
 
-	if (_textUVBuffer != BAD_BUFFER)
-		glDeleteBuffers(1, &_textUVBuffer);
+	glDeleteBuffers(1, &_frameUniformBuffer);
 
 	glDeleteVertexArrays(1, &_textVAO);
 
+	RenderQueue::Instance().Release();
+	MeshRegistry::Instance().Release();
+	StreamBuffer::Instance().Release();
+
 	glfwTerminate();
 }
 
@@ -48,17 +67,29 @@ void Core::Run()
 	// Loop until the user closes the window
 	while (!glfwWindowShouldClose(_window))
 	{
-		glDisable(GL_BLEND);
-		glDepthMask(GL_TRUE);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		GLState& state = GLState::Instance();
+		state.BeginFrame();
+		StreamBuffer::Instance().BeginFrame();
 
-		glUseProgram(_shaderProgram);
-		glUniformMatrix4fv(_uniform_projectionMatrix, 1, GL_FALSE, glm::value_ptr(_projectionMatrix));
-		glUniformMatrix4fv(_uniform_viewMatrix, 1, GL_FALSE, glm::value_ptr(_viewMatrix));
+		// Depth writes must be on for the clear to reach the depth buffer
+		state.Blend(false);
+		state.DepthMask(true);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		double ntime = glfwGetTime();
 
+		// Camera and timing, uploaded once for every program
+		UpdateFrameUniforms(ntime, ntime - time);
+
 		Render(ntime - time);
+		RenderQueue::Instance().Execute(_viewMatrix, [this]() { _impostors.Draw(); });
+
+		// Debug primitives over the scene, under the text
+		_debugDraw.BeginFrame();
+		dd::flush(ddI64(ntime * 1000.0));
+		DrawTextBatch();
+
+		StreamBuffer::Instance().EndFrame();
 
 		time = ntime;
 
@@ -120,56 +151,34 @@ void Core::GLEWInit()
 
 void Core::TextInit()
 {
-	GLint link_ok = GL_FALSE;
-
-	_textProgram = glCreateProgram();
-
-	GLuint vs = loadShader("../shaders/text_vertex.glsl", GL_VERTEX_SHADER);
-	GLuint fs = loadShader("../shaders/text_fragment.glsl", GL_FRAGMENT_SHADER);
+	_textProgram.Create("../shaders/text_vertex.glsl", "../shaders/text_fragment.glsl");
 
-	glAttachShader(_textProgram, vs);
-	glAttachShader(_textProgram, fs);
+	glBindAttribLocation(_textProgram.id(), _attribute_textPosition, "in_position");
+	glBindAttribLocation(_textProgram.id(), _attribute_textUV, "in_uv");
+	glBindAttribLocation(_textProgram.id(), _attribute_textColor, "in_color");
 
-	glBindAttribLocation(_textProgram, _attribute_textPosition, "in_position");
-	glBindAttribLocation(_textProgram, _attribute_textUV, "in_uv");
+	_textProgram.Link("text");
 
-	glLinkProgram(_textProgram);
-	glGetProgramiv(_textProgram, GL_LINK_STATUS, &link_ok);
-	if (!link_ok)
-	{
-		GLint maxLength = 0;
-		glGetProgramiv(_textProgram, GL_INFO_LOG_LENGTH, &maxLength);
-		if (maxLength == 0)
-		{
-			_LOG_CRIT() << "Could not link text shader: No errors reported." << std::endl;
-		}
-
-		{
-			GLchar* link_error = new GLchar[(unsigned int)maxLength];
-			glGetProgramInfoLog(_textProgram, maxLength, &maxLength, link_error);
-			_LOG_CRIT() << "Could not link text shader: " << std::endl << link_error << std::endl;
-		}
-	}
-
-	_uniform_textSampler = glGetUniformLocation(_textProgram, "sampler");
-	_uniform_textColor = glGetUniformLocation(_textProgram, "color");
-
-	glGenBuffers(1, &_textVertexBuffer);
-	glGenBuffers(1, &_textUVBuffer);
+	// The font always sits on unit 0
+	_uniform_textSampler = _textProgram.Uniform("sampler");
+	GLState::Instance().UseProgram(_textProgram.id());
+	glUniform1i(_uniform_textSampler, 0);
 
-	// Create Vertex Array Object
+	// Create Vertex Array Object, position, uv and color interleaved in the stream buffer
 	glGenVertexArrays(1, &_textVAO);
-	glBindVertexArray(_textVAO);
+	GLState::Instance().BindVertexArray(_textVAO);
+	GLState::Instance().BindBuffer(GL_ARRAY_BUFFER, StreamBuffer::Instance().buffer());
 
 	glEnableVertexAttribArray(_attribute_textPosition);
-	glBindBuffer(GL_ARRAY_BUFFER, _textVertexBuffer);
-	glVertexAttribPointer(_attribute_textPosition, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+	glVertexAttribPointer(_attribute_textPosition, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, position));
 
 	glEnableVertexAttribArray(_attribute_textUV);
-	glBindBuffer(GL_ARRAY_BUFFER, _textUVBuffer);
-	glVertexAttribPointer(_attribute_textUV, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+	glVertexAttribPointer(_attribute_textUV, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, uv));
 
-	glBindVertexArray(0);
+	glEnableVertexAttribArray(_attribute_textColor);
+	glVertexAttribPointer(_attribute_textColor, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, color));
+
+	GLState::Instance().BindVertexArray(0);
 
 	_fontTexture = std::unique_ptr<Texture>(new Texture("../consolas.tga"));
 
@@ -178,230 +187,150 @@ void Core::TextInit()
 
 void Core::CoreInit()
 {
-	GLint link_ok = GL_FALSE;
-
-	_shaderProgram = glCreateProgram();
-
-	GLuint vs = loadShader("../shaders/vertex.glsl", GL_VERTEX_SHADER);
-	GLuint fs = loadShader("../shaders/fragment.glsl", GL_FRAGMENT_SHADER);
-
-	glAttachShader(_shaderProgram, vs);
-	glAttachShader(_shaderProgram, fs);
-
-	Shape::InitializePreLink(_shaderProgram);
-	glLinkProgram(_shaderProgram);
-	glGetProgramiv(_shaderProgram, GL_LINK_STATUS, &link_ok);
-	if (!link_ok)
-	{
-		GLint maxLength = 0;
-		glGetProgramiv(_shaderProgram, GL_INFO_LOG_LENGTH, &maxLength);
-		if (maxLength == 0)
-		{
-			_LOG_CRIT() << "Could not link primary shader: No errors reported." << std::endl;
-		}
-
-		{
-			GLchar* link_error = new GLchar[(unsigned int)maxLength];
-			glGetProgramInfoLog(_shaderProgram, maxLength, &maxLength, link_error);
-			_LOG_CRIT() << "Could not link primary shader: " << std::endl << link_error << std::endl;
-		}
-	}
-
+	_shaderProgram.Create("../shaders/vertex.glsl", "../shaders/fragment.glsl");
+	Shape::InitializePreLink(_shaderProgram.id());
+	_shaderProgram.Link("primary");
 	Shape::InitializePostLink(_shaderProgram);
 
-	_uniform_projectionMatrix = glGetUniformLocation(_shaderProgram, "projection");
-	_uniform_viewMatrix = glGetUniformLocation(_shaderProgram, "view");
-
 	_projectionMatrix = glm::perspective(radians(45.0f), decimal(_width) / decimal(_height), 0.1f, 1000.0f);
 
-	glEnable(GL_DEPTH_TEST);
+	GLState::Instance().DepthTest(true);
 	glDepthFunc(GL_LESS);
 	glCullFace(GL_FRONT_AND_BACK);
 
 	debugGLError();
 }
 
-void Core::DrawText(const char* text, glm::vec2 position, const glm::vec4 &color, unsigned int pixel_size, TextAlign align)
+void Core::InstancedInit()
 {
-	glBindVertexArray(0);
-
-	int width, height;
-	glfwGetWindowSize(_window, &width, &height);
-
-	float letter_w = pixel_size / (float)width;
-	float letter_h = pixel_size / (float)height * 2;
-
-	unsigned int length = strlen(text);
-
-	float text_width = length * letter_w;
-	if (align == TextAlign::ALIGN_RIGHT)
-		position.x -= text_width;
-	if (align == TextAlign::ALIGN_CENTER)
-		position.x -= text_width * 0.5f;
-
-	std::vector<glm::vec2> vertices;
-	std::vector<glm::vec2> uv;
-
-	for (unsigned int i = 0; i < length; i++)
-	{
-		glm::vec2 vertex_up_left = glm::vec2(position.x + i*letter_w, position.y + letter_h);
-		glm::vec2 vertex_up_right = glm::vec2(position.x + i*letter_w + letter_w, position.y + letter_h);
-		glm::vec2 vertex_down_right = glm::vec2(position.x + i*letter_w + letter_w, position.y);
-		glm::vec2 vertex_down_left = glm::vec2(position.x + i*letter_w, position.y);
-
-		vertices.push_back(vertex_up_left);
-		vertices.push_back(vertex_down_left);
-		vertices.push_back(vertex_up_right);
-
-		vertices.push_back(vertex_down_right);
-		vertices.push_back(vertex_up_right);
-		vertices.push_back(vertex_down_left);
-
-		const float xd = 16.0f, yd = 8.0f;
-
-		char character = text[i] - '!' + 1;
-		float uv_x = (character % 16) / xd;
-		float uv_y = (character / 16) / yd;
-
-		glm::vec2 uv_up_left = glm::vec2(uv_x, 1.0f - uv_y);
-		glm::vec2 uv_up_right = glm::vec2(uv_x + 1.0f / xd, 1.0f - uv_y);
-		glm::vec2 uv_down_right = glm::vec2(uv_x + 1.0f / xd, 1.0f - (uv_y + 1.0f / yd));
-		glm::vec2 uv_down_left = glm::vec2(uv_x, 1.0f - (uv_y + 1.0f / yd));
-		uv.push_back(uv_up_left);
-		uv.push_back(uv_down_left);
-		uv.push_back(uv_up_right);
-
-		uv.push_back(uv_down_right);
-		uv.push_back(uv_up_right);
-		uv.push_back(uv_down_left);
-	}
+	_instancedProgram.Create("../shaders/vertex_instanced.glsl", "../shaders/fragment_instanced.glsl");
+	RenderQueue::InitializePreLink(_instancedProgram.id());
+	_instancedProgram.Link("instanced");
 
-	// Bind shader
-	glUseProgram(_textProgram);
+	// Baked models share the instanced fragment stage, the color comes from the palette
+	_modelProgram.Create("../shaders/vertex_model.glsl", "../shaders/fragment_instanced.glsl");
+	Node::InitializePreLink(_modelProgram.id());
+	_modelProgram.Link("model");
 
-	glUniform4fv(_uniform_textColor, 1, glm::value_ptr(color));
+	RenderQueue::Instance().InitializePostLink(_shaderProgram.id(), _instancedProgram.id(), _modelProgram.id());
 
-	// Bind texture
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, _fontTexture->glID());
-	glUniform1i(_uniform_textSampler, 0);
-
-	glBindVertexArray(_textVAO);
+	debugGLError();
+}
 
-	//glEnableVertexAttribArray(_attribute_textPosition);
-	glBindBuffer(GL_ARRAY_BUFFER, _textVertexBuffer);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), &vertices[0], GL_STATIC_DRAW);
-	//glVertexAttribPointer(_attribute_textPosition, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+void Core::FrameInit()
+{
+	// Every program declaring the Frame block reads it from this binding point
+	glGenBuffers(1, &_frameUniformBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, _frameUniformBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, _frameUniformBuffer);
 
-	//glEnableVertexAttribArray(_attribute_textUV);
-	glBindBuffer(GL_ARRAY_BUFFER, _textUVBuffer);
-	glBufferData(GL_ARRAY_BUFFER, uv.size() * sizeof(glm::vec2), &uv[0], GL_STATIC_DRAW);
-	//glVertexAttribPointer(_attribute_textUV, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+	debugGLError();
+}
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void Core::UpdateFrameUniforms(double time, double dt)
+{
+	int width, height;
+	glfwGetWindowSize(_window, &width, &height);
 
-	glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+	_frame.projection = _projectionMatrix;
+	_frame.view = _viewMatrix;
+	_frame.view_projection = _projectionMatrix * _viewMatrix;
+	_frustum.Extract(_frame.view_projection);
+	_frame.viewport = vec4(width, height, 1.0f / glm::max(width, 1), 1.0f / glm::max(height, 1));
+	_frame.time = vec4(time, dt, 0, 0);
 
-	glDisable(GL_BLEND);
+	glBindBuffer(GL_UNIFORM_BUFFER, _frameUniformBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &_frame);
+}
 
-	glBindVertexArray(0);
+void Core::ImpostorInit()
+{
+	_impostors.Initialize();
 }
 
-//based on https://github.com/glampert/debug-draw/blob/master/debug_draw.hpp
-void Core::AABB(glm::vec3 min, glm::vec3 max)
+void Core::CaptureImpostor(uint slot, const AABB& bounds, const std::function<void()>& submit)
 {
-	vec3 dim = max - min;
-	vec3 points[8];
-	vec3 bb[2] = { min,max };
+	// Orthographic front view of the square the billboard will cover
+	vec3 center = 0.5f * (bounds.min + bounds.max);
+	vec3 size = bounds.max - bounds.min;
+	float half = 0.5f * glm::max(size.x, size.y);
+	float depth = 0.5f * size.z + 1.0f;
+
+	FrameUniforms frame = _frame;
+	frame.view = lookAt(center + vec3(0, 0, depth), center, vec3(0, 1, 0));
+	frame.projection = ortho(-half, half, -half, half, 0.0f, 2.0f * depth);
+	frame.view_projection = frame.projection * frame.view;
+	const float view_size = IMPOSTOR_SIZE - 2 * IMPOSTOR_PADDING;
+	frame.viewport = vec4(view_size, view_size, 1.0f / view_size, 1.0f / view_size);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, _frameUniformBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frame);
+
+	_impostors.BeginCapture(slot);
+	submit();
+	RenderQueue::Instance().Execute(frame.view);
 
-	//generate points
-	for (int i = 0; i < 8; ++i)
-	{
-		points[i].x = bb[(i ^ (i >> 1)) & 1].x;
-		points[i].y = bb[(i >> 1) & 1].y;
-		points[i].z = bb[(i >> 2) & 1].z;
-	}
+	int width, height;
+	glfwGetFramebufferSize(_window, &width, &height);
+	_impostors.EndCapture(width, height);
 
-	//box generation
-	for (int i = 0; i < 4; ++i)
-	{
-		_lineVertices.push_back(points[i]);
-		_lineVertices.push_back(points[(i + 1) & 3]);
-		_lineVertices.push_back(points[4 + i]);
-		_lineVertices.push_back(points[4 + ((i + 1) & 3)]);
-		_lineVertices.push_back(points[i]);
-		_lineVertices.push_back(points[4 + i]);
-	}
+	glBindBuffer(GL_UNIFORM_BUFFER, _frameUniformBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &_frame);
 }
 
-#define MAX_LINE 4096
-
-void Core::LineInit()
+void Core::DrawText(const char* text, glm::vec2 position, const glm::vec4 &color, unsigned int pixel_size, TextAlign align)
 {
-	GLint link_ok = GL_FALSE;
+	int width, height;
+	glfwGetWindowSize(_window, &width, &height);
 
-	_lineShaderProgram = glCreateProgram();
+	glm::vec2 letter_size(pixel_size / (float)width, pixel_size / (float)height * 2);
 
-	GLuint vs = loadShader("../shaders/line_vertex.glsl", GL_VERTEX_SHADER);
-	GLuint fs = loadShader("../shaders/line_fragment.glsl", GL_FRAGMENT_SHADER);
+	float anchor = 0.0f;
+	if (align == TextAlign::ALIGN_RIGHT)
+		anchor = 1.0f;
+	if (align == TextAlign::ALIGN_CENTER)
+		anchor = 0.5f;
 
-	glAttachShader(_lineShaderProgram, vs);
-	glAttachShader(_lineShaderProgram, fs);
+	// Drawn with every other string at the end of the frame
+	_text.Add(text, position, color, letter_size, anchor);
+}
 
-	glBindAttribLocation(_lineShaderProgram, 0, "in_position");
-	glLinkProgram(_lineShaderProgram);
-	glGetProgramiv(_lineShaderProgram, GL_LINK_STATUS, &link_ok);
-	if (!link_ok)
+void Core::DrawTextBatch()
+{
+	const std::vector<TextVertex>& vertices = _text.vertices();
+	if (vertices.empty())
 	{
-		GLint maxLength = 0;
-		glGetProgramiv(_lineShaderProgram, GL_INFO_LOG_LENGTH, &maxLength);
-		if (maxLength == 0)
-		{
-			_LOG_CRIT() << "Could not link primary shader: No errors reported." << std::endl;
-		}
-
-		{
-			GLchar* link_error = new GLchar[(unsigned int)maxLength];
-			glGetProgramInfoLog(_lineShaderProgram, maxLength, &maxLength, link_error);
-			_LOG_CRIT() << "Could not link primary shader: " << std::endl << link_error << std::endl;
-		}
+		_text.Clear();
+		return;
 	}
 
-	glBindVertexArray(0);
-	glGenVertexArrays(1, &_lineVAO);
-
-	glBindVertexArray(_lineVAO);
+	GLState& state = GLState::Instance();
 
-	glGenBuffers(1, &_lineVertexBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, _lineVertexBuffer);
+	// Bind shader
+	state.UseProgram(_textProgram.id());
 
-	glBufferData(GL_ARRAY_BUFFER, MAX_LINE * 3 * 2 * sizeof(GLfloat), static_cast<GLvoid*>(nullptr), GL_DYNAMIC_DRAW);
+	// Bind texture
+	state.BindTexture(0, _fontTexture->glID());
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), static_cast<GLvoid*>(nullptr));
+	GLintptr offset = StreamBuffer::Instance().Write(vertices.data(), vertices.size() * sizeof(TextVertex), sizeof(TextVertex));
+	state.BindVertexArray(_textVAO);
 
+	state.Blend(true);
+	state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glBindVertexArray(0);
-
-	debugGLError();
+	glDrawArrays(GL_TRIANGLES, offset / sizeof(TextVertex), vertices.size());
 
+	state.Blend(false);
 
+	_text.Clear();
 }
 
-void Core::DrawAABBs()
+void Core::DebugInit()
 {
-	glUseProgram(_lineShaderProgram);
-	glUniformMatrix4fv(glGetUniformLocation(_lineShaderProgram, "projection"), 1, GL_FALSE, value_ptr(_projectionMatrix));
-	glUniformMatrix4fv(glGetUniformLocation(_lineShaderProgram, "view"), 1, GL_FALSE, value_ptr(_viewMatrix));
-
-	glBindVertexArray(_lineVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, _lineVertexBuffer);
-	glBufferData(GL_ARRAY_BUFFER, _lineVertices.size() * sizeof(glm::vec3), &_lineVertices[0], GL_DYNAMIC_DRAW);
-	glDrawArrays(GL_LINES, 0, _lineVertices.size());
-
-	debugGLError();
-	glBindVertexArray(0);
+	// Collects the dd:: primitives queued during the frame, drawn by dd::flush
+	_debugDraw.Initialize(_textProgram.id(), _textVAO, _width, _height);
+	dd::initialize(&_debugDraw);
 }
 
 // Input callbacks
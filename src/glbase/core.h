@@ -1,5 +1,11 @@
 #include <main.h>
 #include "texture.h"
+#include "shader_program.h"
+#include "text_batch.h"
+#include "debug_renderer.h"
+#include "frustum.h"
+#include "impostor.h"
+#include <functional>
 
 class Core
 {
@@ -34,15 +40,25 @@ protected:
 	};
 
 	void DrawText(const char* text, glm::vec2 position, const glm::vec4 &color = glm::vec4(1, 1, 1, 1), unsigned int pixel_size = 32, TextAlign align = ALIGN_LEFT);
-	void AABB(glm::vec3 min, glm::vec3 max);
-	void DrawAABBs();
+
+	// Renders what submit queues into an impostor slot, seen from +z and framed on bounds.
+	// The render queue must be empty, which holds outside of Render.
+	void CaptureImpostor(uint slot, const AABB& bounds, const std::function<void()>& submit);
+	// Draws the slot as a camera facing quad over box this frame
+	void SubmitImpostor(uint slot, const AABB& box) { _impostors.Add(slot, box, _viewMatrix); }
 
 private:
 	void GLFWInit();
 	void GLEWInit();
 	void TextInit();
 	void CoreInit();
-	void LineInit();
+	void InstancedInit();
+	void FrameInit();
+	void ImpostorInit();
+
+	void UpdateFrameUniforms(double time, double dt);
+	void DrawTextBatch();
+	void DebugInit();
 
 	static void MouseClickCallback(GLFWwindow* w, int button, int action, int modifiers);
 	static void MouseScrollCallback(GLFWwindow* w, double dx, double dy);
@@ -54,25 +70,33 @@ private:
 protected:
 	GLFWwindow* _window;
 
-	GLuint _shaderProgram;
+	ShaderProgram _shaderProgram;
+	ShaderProgram _instancedProgram;
+	ShaderProgram _modelProgram;
 
-	GLint _uniform_projectionMatrix, _uniform_viewMatrix;
+	GLuint _frameUniformBuffer;
+	// Last uploaded contents, restored after an impostor capture
+	FrameUniforms _frame;
 
 	glm::mat4 _projectionMatrix, _viewMatrix;
 
-	// Line rendering
-	GLuint _lineVAO;
-	GLuint _lineVertexBuffer;
-	std::vector <glm::vec3> _lineVertices;
-	GLuint _lineShaderProgram;
+	// Extracted from the matrices above along with the frame uniforms
+	Frustum _frustum;
+
+	// Far-field stand-ins, drawn right after the opaque pass
+	ImpostorAtlas _impostors;
+
+	// Debug rendering, fed through the dd:: functions
+	DebugRenderer _debugDraw;
 
 	// Text rendering
 	GLuint _textVAO;
-	GLuint _textVertexBuffer, _textUVBuffer;
-	GLuint _textProgram;
+	ShaderProgram _textProgram;
+
+	GLint _uniform_textSampler;
+	GLint _attribute_textPosition, _attribute_textUV, _attribute_textColor;
 
-	GLint _uniform_textSampler, _uniform_textColor;
-	GLint _attribute_textPosition, _attribute_textUV;
+	TextBatch _text;
 
 	std::unique_ptr<Texture> _fontTexture;
 
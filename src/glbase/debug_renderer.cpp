@@ -0,0 +1,139 @@
+#define DEBUG_DRAW_IMPLEMENTATION
+#include "debug_renderer.h"
+#include "gl_state.h"
+#include "stream_buffer.h"
+
+void DebugRenderer::Initialize(GLuint text_program, GLuint text_vao, uint width, uint height)
+{
+	_textProgram = text_program;
+	_textVAO = text_vao;
+	_width = width;
+	_height = height;
+
+	_lineProgram.Create("../shaders/line_vertex.glsl", "../shaders/line_fragment.glsl");
+	glBindAttribLocation(_lineProgram.id(), 0, "in_position");
+	glBindAttribLocation(_lineProgram.id(), 1, "in_color");
+	_lineProgram.Link("line");
+
+	// Points and lines share the vertex layout: position then color, size ignored
+	glGenVertexArrays(1, &_lineVAO);
+	GLState::Instance().BindVertexArray(_lineVAO);
+	GLState::Instance().BindBuffer(GL_ARRAY_BUFFER, StreamBuffer::Instance().buffer());
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(dd::DrawVertex), (const GLvoid*)0);
+
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(dd::DrawVertex), (const GLvoid*)(3 * sizeof(float)));
+
+	GLState::Instance().BindVertexArray(0);
+
+	debugGLError();
+}
+
+void DebugRenderer::Release()
+{
+	_lineProgram.Release();
+
+	if (_lineVAO)
+		glDeleteVertexArrays(1, &_lineVAO);
+
+	_lineVAO = 0;
+}
+
+void DebugRenderer::beginDraw()
+{
+}
+
+void DebugRenderer::endDraw()
+{
+	GLState& state = GLState::Instance();
+	state.DepthTest(true);
+	state.Blend(false);
+}
+
+dd::GlyphTextureHandle DebugRenderer::createGlyphTexture(int width, int height, const void* pixels)
+{
+	// The text program multiplies its color by the texture, so coverage goes to alpha
+	const unsigned char* coverage = static_cast<const unsigned char*>(pixels);
+	std::vector<unsigned char> rgba(width * height * 4, 255);
+	for (int i = 0; i < width * height; ++i)
+		rgba[i * 4 + 3] = coverage[i];
+
+	GLuint id;
+	glGenTextures(1, &id);
+	GLState::Instance().BindTexture(0, id);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	debugGLError();
+
+	return reinterpret_cast<dd::GlyphTextureHandle>(static_cast<size_t>(id));
+}
+
+void DebugRenderer::destroyGlyphTexture(dd::GlyphTextureHandle glyph_texture)
+{
+	// Unbound first so the cached binding never names a deleted texture
+	GLState::Instance().BindTexture(0, 0);
+
+	GLuint id = static_cast<GLuint>(reinterpret_cast<size_t>(glyph_texture));
+	if (id)
+		glDeleteTextures(1, &id);
+}
+
+void DebugRenderer::drawPointList(const dd::DrawVertex* points, int count, bool depth_enabled)
+{
+	// One size for the whole list, the per-vertex one would need a point size attribute
+	glPointSize(points[0].point.size);
+	DrawVertices(GL_POINTS, points, count, depth_enabled);
+}
+
+void DebugRenderer::drawLineList(const dd::DrawVertex* lines, int count, bool depth_enabled)
+{
+	DrawVertices(GL_LINES, lines, count, depth_enabled);
+}
+
+void DebugRenderer::drawGlyphList(const dd::DrawVertex* glyphs, int count, dd::GlyphTextureHandle glyph_texture)
+{
+	// Pixels from the top left to the text program's unit screen, from the bottom left
+	_glyphs.resize(count);
+	for (int i = 0; i < count; ++i)
+	{
+		const dd::DrawVertex& glyph = glyphs[i];
+		_glyphs[i].position = vec2(glyph.glyph.x / _width, 1.0f - glyph.glyph.y / _height);
+		_glyphs[i].uv = vec2(glyph.glyph.u, glyph.glyph.v);
+		_glyphs[i].color = vec4(glyph.glyph.r, glyph.glyph.g, glyph.glyph.b, 1.0f);
+	}
+
+	GLintptr offset = StreamBuffer::Instance().Write(_glyphs.data(), count * sizeof(TextVertex), sizeof(TextVertex));
+
+	GLState& state = GLState::Instance();
+	state.UseProgram(_textProgram);
+	state.BindTexture(0, static_cast<GLuint>(reinterpret_cast<size_t>(glyph_texture)));
+	state.BindVertexArray(_textVAO);
+
+	state.DepthTest(false);
+	state.Blend(true);
+	state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glDrawArrays(GL_TRIANGLES, offset / sizeof(TextVertex), count);
+	++_drawCalls;
+}
+
+void DebugRenderer::DrawVertices(GLenum mode, const dd::DrawVertex* vertices, int count, bool depth_enabled)
+{
+	GLintptr offset = StreamBuffer::Instance().Write(vertices, count * sizeof(dd::DrawVertex), sizeof(dd::DrawVertex));
+
+	GLState& state = GLState::Instance();
+	state.UseProgram(_lineProgram.id());
+	state.BindVertexArray(_lineVAO);
+	state.DepthTest(depth_enabled);
+	state.Blend(false);
+
+	glDrawArrays(mode, offset / sizeof(dd::DrawVertex), count);
+	++_drawCalls;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <main.h>
+#include "shader_program.h"
+#include "text_batch.h"
+
+// Vertices handed to the renderer per draw; thousands of boxes fit in a few calls
+#define DEBUG_DRAW_VERTEX_BUFFER_SIZE 16384
+#define DEBUG_DRAW_MAX_LINES 65536
+// Callers queueing one point per object cap themselves to it, see the projectile markers
+#define DEBUG_DRAW_MAX_POINTS 8192
+#define DEBUG_DRAW_OVERFLOWED(message) _LOG_INFO() << message
+
+#include <debug_draw.hpp>
+
+// Backend of debug_draw.hpp. Lines and points go through the line program, screen
+// text through the text program and its vertex layout, all streamed per frame.
+class DebugRenderer : public dd::RenderInterface
+{
+public:
+	DebugRenderer() : _lineVAO(0), _textProgram(0), _textVAO(0), _width(1), _height(1), _drawCalls(0) { }
+
+	// The text program and VAO belong to the caller, glyphs are converted to TextVertex
+	void Initialize(GLuint text_program, GLuint text_vao, uint width, uint height);
+
+	// After dd::shutdown, which may still flush through this renderer
+	void Release();
+
+	// Called before each dd::flush, which skips beginDraw when nothing is queued
+	void BeginFrame() { _drawCalls = 0; }
+
+	// Draws issued by the last dd::flush
+	uint draw_calls() const { return _drawCalls; }
+
+	void beginDraw() override;
+	void endDraw() override;
+
+	dd::GlyphTextureHandle createGlyphTexture(int width, int height, const void* pixels) override;
+	void destroyGlyphTexture(dd::GlyphTextureHandle glyph_texture) override;
+
+	void drawPointList(const dd::DrawVertex* points, int count, bool depth_enabled) override;
+	void drawLineList(const dd::DrawVertex* lines, int count, bool depth_enabled) override;
+	void drawGlyphList(const dd::DrawVertex* glyphs, int count, dd::GlyphTextureHandle glyph_texture) override;
+
+private:
+	DebugRenderer(const DebugRenderer&) = delete;
+	DebugRenderer& operator=(const DebugRenderer&) = delete;
+
+	void DrawVertices(GLenum mode, const dd::DrawVertex* vertices, int count, bool depth_enabled);
+
+	ShaderProgram _lineProgram;
+	GLuint _lineVAO;
+
+	GLuint _textProgram, _textVAO;
+	uint _width, _height;
+
+	// Refilled by each flush without reallocating
+	std::vector<TextVertex> _glyphs;
+
+	uint _drawCalls;
+};
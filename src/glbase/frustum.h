@@ -0,0 +1,55 @@
+#pragma once
+
+#include "scene.h"
+
+// View volume as six planes with inward normals, extracted from a view projection
+// matrix (Gribb & Hartmann). Tests are conservative: a box near a corner of the
+// volume may be reported visible while it is not, never the other way around.
+struct Frustum
+{
+	// left, right, bottom, top, near, far; xyz normal, w distance
+	vec4 planes[6];
+
+	void Extract(const mat4& view_projection)
+	{
+		// glm is column major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+		for (int i = 0; i < 3; ++i)
+		{
+			vec4 row(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+			vec4 w(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+
+			planes[i * 2] = w + row;
+			planes[i * 2 + 1] = w - row;
+		}
+
+		for (vec4& plane : planes)
+			plane /= glm::length(vec3(plane));
+	}
+
+	bool Intersects(const AABB& box) const
+	{
+		for (const vec4& plane : planes)
+		{
+			// Corner furthest along the normal; if it is behind, the whole box is
+			vec3 corner(plane.x > 0 ? box.max.x : box.min.x,
+				plane.y > 0 ? box.max.y : box.min.y,
+				plane.z > 0 ? box.max.z : box.min.z);
+
+			if (glm::dot(vec3(plane), corner) + plane.w < 0)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool Intersects(const vec3& center, float radius) const
+	{
+		for (const vec4& plane : planes)
+		{
+			if (glm::dot(vec3(plane), center) + plane.w < -radius)
+				return false;
+		}
+
+		return true;
+	}
+};
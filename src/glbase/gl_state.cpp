@@ -0,0 +1,137 @@
+#include "gl_state.h"
+
+const GLuint GLState::UNKNOWN;
+
+GLState& GLState::Instance()
+{
+	static GLState instance;
+	return instance;
+}
+
+GLState::GLState()
+	: _issued(0), _elided(0), _lastIssued(0), _lastElided(0)
+{
+	Invalidate();
+}
+
+void GLState::UseProgram(GLuint program)
+{
+	if (Changed(_program, program))
+		glUseProgram(program);
+}
+
+void GLState::BindVertexArray(GLuint vao)
+{
+	if (Changed(_vao, vao))
+	{
+		glBindVertexArray(vao);
+
+		// The element buffer binding belongs to the VAO
+		_elementBuffer = UNKNOWN;
+	}
+}
+
+void GLState::BindBuffer(GLenum target, GLuint buffer)
+{
+	if (Changed(target == GL_ELEMENT_ARRAY_BUFFER ? _elementBuffer : _arrayBuffer, buffer))
+		glBindBuffer(target, buffer);
+}
+
+void GLState::BindTexture(GLuint unit, GLuint texture)
+{
+	// Units past the cached ones are forwarded as they are
+	if (unit >= GL_STATE_TEXTURE_UNITS)
+	{
+		if (Changed(_activeUnit, unit))
+			glActiveTexture(GL_TEXTURE0 + unit);
+
+		++_issued;
+		glBindTexture(GL_TEXTURE_2D, texture);
+		return;
+	}
+
+	if (_textures[unit] == texture)
+	{
+		++_elided;
+		return;
+	}
+
+	if (Changed(_activeUnit, unit))
+		glActiveTexture(GL_TEXTURE0 + unit);
+
+	Changed(_textures[unit], texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLState::Blend(bool enabled)
+{
+	if (Changed(_blend, enabled))
+	{
+		if (enabled)
+			glEnable(GL_BLEND);
+		else
+			glDisable(GL_BLEND);
+	}
+}
+
+void GLState::BlendFunc(GLenum source, GLenum destination)
+{
+	if (_blendSource == source && _blendDestination == destination)
+	{
+		++_elided;
+		return;
+	}
+
+	_blendSource = source;
+	_blendDestination = destination;
+	++_issued;
+	glBlendFunc(source, destination);
+}
+
+void GLState::DepthMask(bool enabled)
+{
+	if (Changed(_depthMask, enabled))
+		glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::DepthTest(bool enabled)
+{
+	if (Changed(_depthTest, enabled))
+	{
+		if (enabled)
+			glEnable(GL_DEPTH_TEST);
+		else
+			glDisable(GL_DEPTH_TEST);
+	}
+}
+
+void GLState::Invalidate()
+{
+	_program = _vao = UNKNOWN;
+	_arrayBuffer = _elementBuffer = UNKNOWN;
+	_activeUnit = UNKNOWN;
+	for (GLuint& texture : _textures)
+		texture = UNKNOWN;
+	_blend = _blendSource = _blendDestination = UNKNOWN;
+	_depthMask = _depthTest = UNKNOWN;
+}
+
+void GLState::BeginFrame()
+{
+	_lastIssued = _issued;
+	_lastElided = _elided;
+	_issued = _elided = 0;
+}
+
+bool GLState::Changed(GLuint& cached, GLuint value)
+{
+	if (cached == value)
+	{
+		++_elided;
+		return false;
+	}
+
+	cached = value;
+	++_issued;
+	return true;
+}
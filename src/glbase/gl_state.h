@@ -0,0 +1,56 @@
+#pragma once
+
+#include <main.h>
+
+#define GL_STATE_TEXTURE_UNITS 8
+
+// Shadow copy of the GL state the renderer touches.
+// Each setter compares with the value it last set and skips the GL call when nothing
+// would change. Every change of this state has to go through here, otherwise the
+// cache goes stale and skips calls that were actually needed; call Invalidate after
+// touching it directly.
+class GLState
+{
+public:
+	static GLState& Instance();
+
+	void UseProgram(GLuint program);
+	void BindVertexArray(GLuint vao);
+	// GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER; the latter is part of the bound VAO
+	void BindBuffer(GLenum target, GLuint buffer);
+	// 2D textures only; units from GL_STATE_TEXTURE_UNITS on are not cached
+	void BindTexture(GLuint unit, GLuint texture);
+
+	void Blend(bool enabled);
+	void BlendFunc(GLenum source, GLenum destination);
+	void DepthMask(bool enabled);
+	void DepthTest(bool enabled);
+
+	// Forgets every cached value, so the next call to each setter reaches GL
+	void Invalidate();
+
+	// Starts counting calls for a new frame
+	void BeginFrame();
+
+	// Calls forwarded to GL and calls skipped during the last complete frame
+	uint issued() const { return _lastIssued; }
+	uint elided() const { return _lastElided; }
+
+private:
+	GLState();
+
+	static const GLuint UNKNOWN = UINT_MAX;
+
+	// Counts the call and tells whether it has to reach GL
+	bool Changed(GLuint& cached, GLuint value);
+
+	GLuint _program, _vao;
+	GLuint _arrayBuffer, _elementBuffer;
+	GLuint _activeUnit;
+	GLuint _textures[GL_STATE_TEXTURE_UNITS];
+	GLuint _blend, _blendSource, _blendDestination;
+	GLuint _depthMask, _depthTest;
+
+	uint _issued, _elided;
+	uint _lastIssued, _lastElided;
+};
@@ -0,0 +1,83 @@
+#include "grid.h"
+#include <algorithm>
+
+UniformGrid::UniformGrid(const AABB& bounds, const vec3& cell_size)
+	: _bounds(bounds), _cellSize(cell_size), _queryStamp(0)
+{
+	vec3 extent = (bounds.max - bounds.min) / cell_size;
+	_cells = ivec3(glm::max(ivec3(ceil(extent)), ivec3(1)));
+	_cellStart.assign(_cells.x * _cells.y * _cells.z + 1, 0);
+}
+
+void UniformGrid::Clear()
+{
+	_entries.clear();
+}
+
+ivec3 UniformGrid::Cell(const vec3& p) const
+{
+	ivec3 cell = ivec3(floor((p - _bounds.min) / _cellSize));
+	return clamp(cell, ivec3(0), _cells - 1);
+}
+
+void UniformGrid::Insert(uint id, const AABB& box)
+{
+	ivec3 lo = Cell(box.min), hi = Cell(box.max);
+	for (int z = lo.z; z <= hi.z; ++z)
+		for (int y = lo.y; y <= hi.y; ++y)
+			for (int x = lo.x; x <= hi.x; ++x)
+				_entries.push_back({ Index(x, y, z), id });
+
+	if (id >= _stamps.size())
+		_stamps.resize(id + 1, 0);
+}
+
+void UniformGrid::Build()
+{
+	// Counting sort of the entries by cell
+	std::fill(_cellStart.begin(), _cellStart.end(), 0);
+	for (const Entry& entry : _entries)
+		++_cellStart[entry.cell + 1];
+
+	for (uint i = 1; i < _cellStart.size(); ++i)
+		_cellStart[i] += _cellStart[i - 1];
+
+	_ids.resize(_entries.size());
+	for (const Entry& entry : _entries)
+		_ids[_cellStart[entry.cell]++] = entry.id;
+
+	// The scatter advanced every start to the next cell's, shift them back
+	for (uint i = _cellStart.size() - 1; i > 0; --i)
+		_cellStart[i] = _cellStart[i - 1];
+	_cellStart[0] = 0;
+}
+
+const std::vector<uint>& UniformGrid::Query(const AABB& box)
+{
+	_results.clear();
+
+	if (++_queryStamp == 0)
+	{
+		std::fill(_stamps.begin(), _stamps.end(), 0);
+		_queryStamp = 1;
+	}
+
+	ivec3 lo = Cell(box.min), hi = Cell(box.max);
+	for (int z = lo.z; z <= hi.z; ++z)
+		for (int y = lo.y; y <= hi.y; ++y)
+			for (int x = lo.x; x <= hi.x; ++x)
+			{
+				uint cell = Index(x, y, z);
+				for (uint i = _cellStart[cell]; i < _cellStart[cell + 1]; ++i)
+				{
+					uint id = _ids[i];
+					if (_stamps[id] != _queryStamp)
+					{
+						_stamps[id] = _queryStamp;
+						_results.push_back(id);
+					}
+				}
+			}
+
+	return _results;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "scene.h"
+
+// Uniform grid broad phase.
+// Boxes are bucketed into fixed-size cells covering the playfield; anything outside is
+// clamped into the border cells. The grid is rebuilt every frame: Clear, Insert all
+// boxes, Build, then Query as many times as needed.
+class UniformGrid
+{
+public:
+	UniformGrid(const AABB& bounds, const vec3& cell_size);
+
+	void Clear();
+	void Insert(uint id, const AABB& box);
+	void Build();
+
+	// Ids of every box sharing a cell with `box`, each reported once
+	const std::vector<uint>& Query(const AABB& box);
+
+private:
+	ivec3 Cell(const vec3& p) const;
+	uint Index(int x, int y, int z) const { return (z * _cells.y + y) * _cells.x + x; }
+
+	struct Entry
+	{
+		uint cell;
+		uint id;
+	};
+
+	AABB _bounds;
+	vec3 _cellSize;
+	ivec3 _cells;
+
+	std::vector<Entry> _entries;
+	std::vector<uint> _cellStart;	// Compressed cell -> ids table, filled by Build()
+	std::vector<uint> _ids;
+
+	std::vector<uint> _stamps;		// Last query each id was reported in
+	uint _queryStamp;
+	std::vector<uint> _results;
+};
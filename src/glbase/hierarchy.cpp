@@ -0,0 +1,275 @@
+#include "hierarchy.h"
+#include <cstring>
+
+const uint TransformHierarchy::NONE;
+
+TransformHierarchy& TransformHierarchy::Instance()
+{
+	static TransformHierarchy instance;
+	return instance;
+}
+
+TransformHierarchy::Handle TransformHierarchy::Create()
+{
+	Handle node;
+	if (!_freeHandles.empty())
+	{
+		node = _freeHandles.back();
+		_freeHandles.pop_back();
+	}
+	else
+	{
+		node = _slots.size();
+		_slots.push_back(NONE);
+		_parentOf.push_back(NONE);
+		_firstChild.push_back(NONE);
+		_nextSibling.push_back(NONE);
+	}
+
+	// A new root appended at the end keeps the depth-first order valid
+	uint slot = _handles.size();
+	_slots[node] = slot;
+	_parentOf[node] = _firstChild[node] = _nextSibling[node] = NONE;
+
+	_handles.push_back(node);
+	_parents.push_back(NONE);
+	_subtreeEnds.push_back(slot + 1);
+	_roots.push_back(slot);
+	_treeDirty.push_back(0);
+	_treeRevisions.push_back(++_revision);
+	_locals.push_back(simdMat4());
+	_worlds.push_back(simdMat4());
+	_versions.push_back(0);
+	_dirty.push_back(0);
+
+	return node;
+}
+
+void TransformHierarchy::Destroy(Handle node)
+{
+	if (_parentOf[node] != NONE)
+		Unlink(node);
+
+	// Orphaned children become roots
+	for (Handle child = _firstChild[node]; child != NONE;)
+	{
+		Handle next = _nextSibling[child];
+		_parentOf[child] = _nextSibling[child] = NONE;
+		_dirty[_slots[child]] = 1;
+		child = next;
+	}
+	_firstChild[node] = NONE;
+
+	_handles[_slots[node]] = NONE;
+	_slots[node] = NONE;
+	_freeHandles.push_back(node);
+
+	_anyDirty = _reorder = true;
+}
+
+void TransformHierarchy::SetParent(Handle node, Handle parent)
+{
+	if (_parentOf[node] == parent)
+		return;
+
+	if (_parentOf[node] != NONE)
+		Unlink(node);
+
+	if (parent != NONE)
+	{
+		_nextSibling[node] = _firstChild[parent];
+		_firstChild[parent] = node;
+	}
+	_parentOf[node] = parent;
+
+	_dirty[_slots[node]] = 1;
+	_anyDirty = _reorder = true;
+}
+
+void TransformHierarchy::Unlink(Handle node)
+{
+	Handle parent = _parentOf[node];
+	if (_firstChild[parent] == node)
+	{
+		_firstChild[parent] = _nextSibling[node];
+	}
+	else
+	{
+		Handle sibling = _firstChild[parent];
+		while (_nextSibling[sibling] != node)
+			sibling = _nextSibling[sibling];
+		_nextSibling[sibling] = _nextSibling[node];
+	}
+
+	_parentOf[node] = _nextSibling[node] = NONE;
+}
+
+void TransformHierarchy::SetLocal(Handle node, const mat4& local)
+{
+	uint slot = _slots[node];
+	_locals[slot] = simdMat4(local);
+	_dirty[slot] = 1;
+	_treeDirty[_roots[slot]] = 1;
+	_anyDirty = true;
+}
+
+mat4 TransformHierarchy::Local(Handle node) const
+{
+	return mat4_cast(_locals[_slots[node]]);
+}
+
+mat4 TransformHierarchy::World(Handle node)
+{
+	return mat4_cast(_worlds[Refresh(node)]);
+}
+
+uint TransformHierarchy::Version(Handle node)
+{
+	return _versions[Refresh(node)];
+}
+
+uint TransformHierarchy::TreeRevision(Handle node)
+{
+	return _treeRevisions[_roots[Refresh(node)]];
+}
+
+uint TransformHierarchy::Refresh(Handle node)
+{
+	if (_reorder)
+		Rebuild();
+
+	uint slot = _slots[node];
+	uint root = _roots[slot];
+	if (_treeDirty[root])
+	{
+		// Only bring the tree holding this node up to date, the rest waits for Update()
+		UpdateRange(root, _subtreeEnds[root]);
+		_treeDirty[root] = 0;
+	}
+
+	return slot;
+}
+
+void TransformHierarchy::Update()
+{
+	if (_reorder)
+		Rebuild();
+
+	if (!_anyDirty)
+		return;
+
+	UpdateRange(0, _handles.size());
+	if (!_treeDirty.empty())
+		memset(&_treeDirty[0], 0, _treeDirty.size());
+	_anyDirty = false;
+}
+
+void TransformHierarchy::UpdateRange(uint begin, uint end)
+{
+	// Parents precede their children, so a single forward pass both recomputes
+	// and propagates the dirty flags down the tree
+	for (uint i = begin; i < end; ++i)
+	{
+		uint parent = _parents[i];
+		if (parent == NONE)
+		{
+			if (!_dirty[i])
+				continue;
+			_worlds[i] = _locals[i];
+		}
+		else if (_dirty[i] | _dirty[parent])
+		{
+			_worlds[i] = _worlds[parent] * _locals[i];
+			_dirty[i] = 1;
+		}
+		else
+		{
+			continue;
+		}
+
+		++_versions[i];
+		_treeRevisions[_roots[i]] = ++_revision;
+	}
+
+	if (end > begin)
+		memset(&_dirty[begin], 0, end - begin);
+}
+
+void TransformHierarchy::Rebuild()
+{
+	std::vector<Handle> handles;
+	handles.reserve(_handles.size());
+
+	// Lay out every root's subtree depth-first, dropping destroyed entries
+	std::vector<Handle> stack;
+	for (Handle root : _handles)
+	{
+		if (root == NONE || _parentOf[root] != NONE)
+			continue;
+
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			Handle node = stack.back();
+			stack.pop_back();
+			handles.push_back(node);
+
+			for (Handle child = _firstChild[node]; child != NONE; child = _nextSibling[child])
+				stack.push_back(child);
+		}
+	}
+
+	uint count = handles.size();
+	std::vector<uint> parents(count), subtreeEnds(count), roots(count);
+	MatrixArray locals(count), worlds(count);
+	std::vector<uint> versions(count);
+	std::vector<unsigned char> dirty(count), treeDirty(count, 0);
+	std::vector<uint> treeRevisions(count, 0);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		uint old = _slots[handles[i]];
+		locals[i] = _locals[old];
+		worlds[i] = _worlds[old];
+		versions[i] = _versions[old];
+		dirty[i] = _dirty[old];
+	}
+
+	for (uint i = 0; i < count; ++i)
+		_slots[handles[i]] = i;
+
+	for (uint i = 0; i < count; ++i)
+	{
+		Handle parent = _parentOf[handles[i]];
+		parents[i] = parent == NONE ? NONE : _slots[parent];
+		subtreeEnds[i] = i + 1;
+
+		// Parents come first, their root is already known
+		roots[i] = parents[i] == NONE ? i : roots[parents[i]];
+		if (dirty[i])
+			treeDirty[roots[i]] = 1;
+
+		// Trees may have gained or lost nodes, none keeps its revision
+		if (parents[i] == NONE)
+			treeRevisions[i] = ++_revision;
+	}
+
+	for (uint i = count; i-- > 0;)
+	{
+		if (parents[i] != NONE)
+			subtreeEnds[parents[i]] = max(subtreeEnds[parents[i]], subtreeEnds[i]);
+	}
+
+	std::swap(_handles, handles);
+	std::swap(_parents, parents);
+	std::swap(_subtreeEnds, subtreeEnds);
+	std::swap(_roots, roots);
+	std::swap(_treeDirty, treeDirty);
+	std::swap(_treeRevisions, treeRevisions);
+	std::swap(_locals, locals);
+	std::swap(_worlds, worlds);
+	std::swap(_versions, versions);
+	std::swap(_dirty, dirty);
+
+	_reorder = false;
+}
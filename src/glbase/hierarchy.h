@@ -0,0 +1,111 @@
+#pragma once
+
+#include <main.h>
+#include <glm/gtx/simd_mat4.hpp>
+#include <new>
+
+using namespace glm;
+
+// std::allocator only honours the alignment of fundamental types before C++17, and the
+// 32-bit MSVC heap is 8-byte aligned, too little for the SSE loads of simdMat4
+template <typename T, size_t Alignment>
+class AlignedAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template <typename U>
+	struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+	AlignedAllocator() { }
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) { }
+
+	T* allocate(size_t count)
+	{
+		void* memory = _mm_malloc(count * sizeof(T), Alignment);
+		if (!memory)
+			throw std::bad_alloc();
+		return static_cast<T*>(memory);
+	}
+
+	void deallocate(T* memory, size_t) { _mm_free(memory); }
+
+	template <typename U>
+	bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+	template <typename U>
+	bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+// Flat transform store shared by every Node.
+// Local and world matrices live in contiguous arrays kept in depth-first order, so a
+// parent always precedes its children and each subtree occupies a contiguous range.
+// Nodes refer to their entry through a stable handle, as the dense order changes
+// whenever the hierarchy is modified.
+class TransformHierarchy
+{
+public:
+	typedef uint Handle;
+	static const uint NONE = UINT_MAX;
+
+	static TransformHierarchy& Instance();
+
+	Handle Create();
+	void Destroy(Handle node);
+	void SetParent(Handle node, Handle parent);
+
+	void SetLocal(Handle node, const mat4& local);
+	mat4 Local(Handle node) const;
+	mat4 World(Handle node);
+
+	// Incremented every time the node's world matrix is recomputed
+	uint Version(Handle node);
+	// Incremented every time any world matrix is recomputed
+	uint Revision() const { return _revision; }
+	// Changes every time a world matrix of the tree holding the node is recomputed,
+	// or when that tree is restructured
+	uint TreeRevision(Handle node);
+
+	// Recomputes every dirty world matrix in a single linear pass
+	void Update();
+
+	uint size() const { return _handles.size(); }
+
+private:
+	TransformHierarchy() : _revision(0), _anyDirty(false), _reorder(false) { }
+
+	typedef std::vector<simdMat4, AlignedAllocator<simdMat4, 16> > MatrixArray;
+
+	uint Refresh(Handle node);
+	void Rebuild();
+	void Unlink(Handle node);
+	void UpdateRange(uint begin, uint end);
+
+	// Per handle
+	std::vector<uint> _slots;
+	std::vector<Handle> _parentOf, _firstChild, _nextSibling;
+	std::vector<Handle> _freeHandles;
+
+	// Dense, depth-first order
+	std::vector<Handle> _handles;
+	std::vector<uint> _parents;
+	std::vector<uint> _subtreeEnds;
+	// Slot of the root of the tree holding each entry
+	std::vector<uint> _roots;
+	MatrixArray _locals, _worlds;
+	std::vector<uint> _versions;
+	std::vector<unsigned char> _dirty;
+	// Set on a root when something below it is dirty, so queries skip clean trees at once
+	std::vector<unsigned char> _treeDirty;
+	// Per root, the value of _revision when one of the tree's world matrices last changed
+	std::vector<uint> _treeRevisions;
+
+	uint _revision;
+	bool _anyDirty, _reorder;
+};
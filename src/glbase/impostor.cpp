@@ -0,0 +1,157 @@
+#include "impostor.h"
+#include "gl_state.h"
+#include "stream_buffer.h"
+#include <cstddef>
+
+void ImpostorAtlas::Initialize()
+{
+	_program.Create("../shaders/impostor_vertex.glsl", "../shaders/impostor_fragment.glsl");
+	glBindAttribLocation(_program.id(), 0, "in_position");
+	glBindAttribLocation(_program.id(), 1, "in_uv");
+	_program.Link("impostor");
+
+	GLState& state = GLState::Instance();
+	state.UseProgram(_program.id());
+	glUniform1i(_program.Uniform("sampler"), 0);
+
+	// Color with alpha for the silhouette, depth so the parts hide each other
+	glGenTextures(1, &_texture);
+	state.BindTexture(0, _texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, IMPOSTOR_SIZE * IMPOSTOR_SLOTS, IMPOSTOR_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, IMPOSTOR_MAX_LEVEL);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	glGenRenderbuffers(1, &_depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, _depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, IMPOSTOR_SIZE * IMPOSTOR_SLOTS, IMPOSTOR_SIZE);
+
+	glGenFramebuffers(1, &_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depth);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		_LOG_INFO() << "Impostor framebuffer incomplete, far entities will show nothing.";
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	glGenVertexArrays(1, &_vao);
+	state.BindVertexArray(_vao);
+	state.BindBuffer(GL_ARRAY_BUFFER, StreamBuffer::Instance().buffer());
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, position));
+
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, uv));
+
+	state.BindVertexArray(0);
+
+	debugGLError();
+}
+
+void ImpostorAtlas::Release()
+{
+	_program.Release();
+
+	if (_framebuffer)
+		glDeleteFramebuffers(1, &_framebuffer);
+	if (_depth)
+		glDeleteRenderbuffers(1, &_depth);
+	if (_texture)
+		glDeleteTextures(1, &_texture);
+	if (_vao)
+		glDeleteVertexArrays(1, &_vao);
+
+	_framebuffer = _depth = _texture = _vao = 0;
+}
+
+void ImpostorAtlas::BeginCapture(uint slot)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	glViewport(slot * IMPOSTOR_SIZE + IMPOSTOR_PADDING, IMPOSTOR_PADDING, IMPOSTOR_SIZE - 2 * IMPOSTOR_PADDING, IMPOSTOR_SIZE - 2 * IMPOSTOR_PADDING);
+
+	// Only this slot is cleared, border included, the others keep their view
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(slot * IMPOSTOR_SIZE, 0, IMPOSTOR_SIZE, IMPOSTOR_SIZE);
+
+	GLState& state = GLState::Instance();
+	state.DepthMask(true);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void ImpostorAtlas::EndCapture(int width, int height)
+{
+	glDisable(GL_SCISSOR_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, width, height);
+
+	GLState::Instance().BindTexture(0, _texture);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	debugGLError();
+}
+
+void ImpostorAtlas::Add(uint slot, const AABB& box, const mat4& view)
+{
+	// Camera axes in world space are the rows of the view rotation
+	vec3 right(view[0][0], view[1][0], view[2][0]);
+	vec3 up(view[0][1], view[1][1], view[2][1]);
+
+	vec3 center = 0.5f * (box.min + box.max);
+	vec3 size = box.max - box.min;
+	float half = 0.5f * glm::max(size.x, size.y);
+
+	right *= half;
+	up *= half;
+
+	// The view covers the slot minus its border
+	float u0 = float(slot * IMPOSTOR_SIZE + IMPOSTOR_PADDING) / (IMPOSTOR_SIZE * IMPOSTOR_SLOTS);
+	float u1 = float((slot + 1) * IMPOSTOR_SIZE - IMPOSTOR_PADDING) / (IMPOSTOR_SIZE * IMPOSTOR_SLOTS);
+	float v0 = float(IMPOSTOR_PADDING) / IMPOSTOR_SIZE;
+	float v1 = float(IMPOSTOR_SIZE - IMPOSTOR_PADDING) / IMPOSTOR_SIZE;
+
+	Vertex corners[4] = {
+		{ center - right - up, vec2(u0, v0) },
+		{ center + right - up, vec2(u1, v0) },
+		{ center - right + up, vec2(u0, v1) },
+		{ center + right + up, vec2(u1, v1) }
+	};
+
+	_vertices.push_back(corners[0]);
+	_vertices.push_back(corners[1]);
+	_vertices.push_back(corners[2]);
+
+	_vertices.push_back(corners[2]);
+	_vertices.push_back(corners[1]);
+	_vertices.push_back(corners[3]);
+}
+
+void ImpostorAtlas::Draw()
+{
+	_count = _vertices.size() / 6;
+	if (_vertices.empty())
+		return;
+
+	GLintptr offset = StreamBuffer::Instance().Write(_vertices.data(), _vertices.size() * sizeof(Vertex), sizeof(Vertex));
+
+	GLState& state = GLState::Instance();
+	state.UseProgram(_program.id());
+	state.BindTexture(0, _texture);
+	state.BindVertexArray(_vao);
+
+	// Alpha tested in the shader, so the quads are opaque for the depth buffer
+	state.Blend(false);
+	state.DepthMask(true);
+
+	glDrawArrays(GL_TRIANGLES, offset / sizeof(Vertex), _vertices.size());
+
+	_vertices.clear();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <main.h>
+#include "shader_program.h"
+#include "scene.h"
+
+// Pixels per side of one captured view
+#define IMPOSTOR_SIZE 128
+// Views side by side in the atlas texture
+#define IMPOSTOR_SLOTS 4
+// Transparent border kept around each view inside its slot, so filtering and the
+// smaller mip levels never reach into the neighbouring slots
+#define IMPOSTOR_PADDING 8
+// Last mip level generated; one texel there still fits in the border
+#define IMPOSTOR_MAX_LEVEL 3
+
+// Far-field stand-ins: each slot holds one view of a model rendered to texture once,
+// drawn afterwards as camera facing quads covering the model's bounds. Every quad of
+// the frame comes from the same texture and is drawn with a single call.
+class ImpostorAtlas
+{
+public:
+	ImpostorAtlas() : _framebuffer(0), _texture(0), _depth(0), _vao(0), _count(0) { }
+
+	void Initialize();
+
+	void Release();
+
+	// Redirects rendering to the slot, cleared, inside its border; the caller draws the model in between
+	void BeginCapture(uint slot);
+	// Back to the default framebuffer with the given viewport
+	void EndCapture(int width, int height);
+
+	// Queues a quad facing the camera, covering box
+	void Add(uint slot, const AABB& box, const mat4& view);
+	// Draws every queued quad, the depth buffer must hold the opaque scene
+	void Draw();
+
+	// Quads drawn by the last Draw
+	uint count() const { return _count; }
+
+private:
+	ImpostorAtlas(const ImpostorAtlas&) = delete;
+	ImpostorAtlas& operator=(const ImpostorAtlas&) = delete;
+
+	struct Vertex
+	{
+		vec3 position;
+		vec2 uv;
+	};
+
+	ShaderProgram _program;
+	GLuint _framebuffer, _texture, _depth;
+	GLuint _vao;
+
+	// Quads of the current frame, cleared rather than freed
+	std::vector<Vertex> _vertices;
+	uint _count;
+};
@@ -0,0 +1,33 @@
+#include "lod.h"
+#include <cfloat>
+
+// Smallest projected size of each tessellated level, in pixels
+static const float lod_thresholds[MESH_LOD_LEVELS] = { 128.0f, 56.0f, 28.0f };
+
+float ProjectedSize(const AABB& box, const mat4& view, const mat4& projection, float viewport_height)
+{
+	vec3 center = 0.5f * (box.min + box.max);
+	float radius = 0.5f * glm::length(box.max - box.min);
+
+	float depth = -(view * vec4(center, 1.0f)).z;
+	if (depth <= radius)
+		return FLT_MAX;
+
+	// projection[1][1] is the cotangent of half the vertical field of view
+	return radius * projection[1][1] * viewport_height / depth;
+}
+
+uint SelectLod(uint current, float screen_size)
+{
+	uint level = glm::min(current, uint(LOD_IMPOSTOR));
+
+	// Coarser once clearly below this level's threshold
+	while (level < LOD_IMPOSTOR && screen_size < lod_thresholds[level] * (1.0f - LOD_HYSTERESIS))
+		++level;
+
+	// Finer once clearly above the next finer level's threshold
+	while (level > 0 && screen_size > lod_thresholds[level - 1] * (1.0f + LOD_HYSTERESIS))
+		--level;
+
+	return level;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "scene.h"
+
+// Level drawn as a camera facing billboard instead of geometry
+#define LOD_IMPOSTOR MESH_LOD_LEVELS
+
+// Fraction a screen size must cross a threshold by before the level changes, so an
+// entity hovering around one does not switch back and forth every frame
+#define LOD_HYSTERESIS 0.2f
+
+// Height in pixels of the bounding sphere of box, infinite if the camera is inside it
+float ProjectedSize(const AABB& box, const mat4& view, const mat4& projection, float viewport_height);
+
+// Level to draw with given the current one and the projected size, between 0 and LOD_IMPOSTOR
+uint SelectLod(uint current, float screen_size);
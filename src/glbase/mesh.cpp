@@ -0,0 +1,586 @@
+#include "mesh.h"
+#include "scene.h"
+#include "gl_state.h"
+#include "mesh_optimizer.h"
+#include <cstddef>
+
+void Mesh::Draw() const
+{
+	// Left bound, the next draw rebinds only if it uses another format
+	GLState::Instance().BindVertexArray(vao);
+
+	if (baseVertex)
+		glDrawElementsBaseVertex(GL_TRIANGLES, count, indexType, (const GLvoid*)indexOffset, baseVertex);
+	else
+		glDrawElements(GL_TRIANGLES, count, indexType, (const GLvoid*)indexOffset);
+}
+
+void Mesh::DrawInstanced(GLsizei instances) const
+{
+	GLState::Instance().BindVertexArray(vao);
+
+	if (baseVertex)
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, indexType, (const GLvoid*)indexOffset, instances, baseVertex);
+	else
+		glDrawElementsInstanced(GL_TRIANGLES, count, indexType, (const GLvoid*)indexOffset, instances);
+}
+
+MeshRegistry& MeshRegistry::Instance()
+{
+	static MeshRegistry instance;
+	return instance;
+}
+
+void MeshRegistry::Initialize()
+{
+	// Packed normals need GL 3.3 or ARB_vertex_type_2_10_10_10_rev, otherwise the full layout is kept
+	_compact = GLEW_VERSION_3_3 || GLEW_ARB_vertex_type_2_10_10_10_rev;
+	_baseVertex = GLEW_VERSION_3_2 || GLEW_ARB_draw_elements_base_vertex;
+
+	if (!_baseVertex)
+	{
+		_LOG_INFO() << "Base vertex draws not supported, mesh indices are rebased at upload.";
+	}
+
+	glGenVertexArrays(VERTEX_COMPACT + 1, _vao);
+
+	for (Arena& arena : _vertices)
+	{
+		glGenBuffers(1, &arena.buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, arena.buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, MESH_BUFFER_SIZE, nullptr, GL_STATIC_DRAW);
+		arena.size = 0;
+		arena.capacity = MESH_BUFFER_SIZE;
+	}
+
+	glGenBuffers(1, &_indices.buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _indices.buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, MESH_BUFFER_SIZE, nullptr, GL_STATIC_DRAW);
+	_indices.size = 0;
+	_indices.capacity = MESH_BUFFER_SIZE;
+
+	SetupVertexArrays();
+
+	debugGLError();
+}
+
+const Mesh* MeshRegistry::Get(const MeshKey& key)
+{
+	auto found = _meshes.find(key);
+	if (found != _meshes.end())
+		return &found->second;
+
+	std::vector<VertexPositionNormal> vertices;
+	std::vector<uint> indices;
+	Build(key, vertices, indices);
+
+	Mesh& mesh = _meshes[key];
+	if (key.format == VERTEX_COMPACT && _compact)
+	{
+		std::vector<VertexCompact> packed;
+		Pack(vertices, packed);
+		mesh = Upload(VERTEX_COMPACT, packed.data(), packed.size(), indices);
+	}
+	else
+		mesh = Upload(VERTEX_FLOAT, vertices.data(), vertices.size(), indices);
+
+	mesh.radius = ComputeRadius(vertices);
+	return &mesh;
+}
+
+const Mesh* MeshRegistry::GetModel(const std::vector<MeshKey>& parts)
+{
+	if (!_compact || parts.size() > MODEL_MAX_PARTS)
+		return nullptr;
+
+	auto found = _models.find(parts);
+	if (found != _models.end())
+		return &found->second;
+
+	std::vector<VertexCompact> packed;
+	std::vector<uint> indices;
+
+	std::vector<VertexPositionNormal> part_vertices;
+	std::vector<uint> part_indices;
+	std::vector<VertexCompact> part_packed;
+	float radius = 0;
+
+	// Parts one after the other, each keeping its own cache order
+	for (uint part = 0; part < parts.size(); ++part)
+	{
+		Build(parts[part], part_vertices, part_indices);
+		Pack(part_vertices, part_packed);
+		radius = glm::max(radius, ComputeRadius(part_vertices));
+
+		for (VertexCompact& vertex : part_packed)
+			vertex.part = part;
+		for (uint index : part_indices)
+			indices.push_back(index + packed.size());
+
+		packed.insert(packed.end(), part_packed.begin(), part_packed.end());
+	}
+
+	Mesh& mesh = _models[parts] = Upload(VERTEX_COMPACT, packed.data(), packed.size(), indices);
+	mesh.radius = radius;
+	return &mesh;
+}
+
+void MeshRegistry::Build(const MeshKey& key, std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices)
+{
+	Generate(key, vertices, indices);
+
+	// Shared vertices, triangles in post-transform cache order, vertices in fetch order
+	uint generated = vertices.size();
+	float acmr = indices.empty() ? 3.0f : ComputeACMR(indices, vertices.size());
+
+	WeldVertices(vertices, indices);
+	OptimizeVertexCache(indices, vertices.size());
+	OptimizeVertexFetch(vertices, indices);
+
+	_LOG_INFO() << "Mesh " << key.type << "/" << key.iterations << ": " << generated << " -> " << vertices.size()
+		<< " vertices, ACMR " << acmr << " -> " << ComputeACMR(indices, vertices.size());
+}
+
+Mesh MeshRegistry::Upload(VertexFormat format, const void* vertices, uint vertex_count, std::vector<uint>& indices)
+{
+	Mesh mesh;
+	mesh.format = format;
+	mesh.vao = _vao[format];
+	mesh.count = indices.size();
+	mesh.id = _meshes.size() + _models.size();
+
+	// Vertices go after the previous mesh of the same format, at a whole vertex
+	GLsizeiptr stride = format == VERTEX_COMPACT ? sizeof(VertexCompact) : sizeof(VertexPositionNormal);
+	GLintptr vertex_offset = Append(_vertices[format], vertices, vertex_count * stride, stride);
+
+	GLint first_vertex = vertex_offset / stride;
+	if (_baseVertex)
+	{
+		mesh.baseVertex = first_vertex;
+		mesh.indexType = vertex_count <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+	else
+	{
+		// Absolute indices may not fit 16 bits anymore
+		for (uint& index : indices)
+			index += first_vertex;
+		mesh.baseVertex = 0;
+		mesh.indexType = GL_UNSIGNED_INT;
+	}
+
+	if (mesh.indexType == GL_UNSIGNED_SHORT)
+	{
+		std::vector<unsigned short> shorts(indices.begin(), indices.end());
+		mesh.indexOffset = Append(_indices, shorts.data(), shorts.size() * sizeof(unsigned short), sizeof(unsigned short));
+	}
+	else
+		mesh.indexOffset = Append(_indices, indices.data(), indices.size() * sizeof(uint), sizeof(uint));
+
+	debugGLError();
+
+	return mesh;
+}
+
+void MeshRegistry::Release()
+{
+	for (Arena& arena : _vertices)
+	{
+		if (arena.buffer)
+			glDeleteBuffers(1, &arena.buffer);
+		arena = Arena();
+	}
+
+	if (_indices.buffer)
+		glDeleteBuffers(1, &_indices.buffer);
+	_indices = Arena();
+
+	if (_vao[0])
+		glDeleteVertexArrays(VERTEX_COMPACT + 1, _vao);
+	_vao[VERTEX_FLOAT] = _vao[VERTEX_COMPACT] = 0;
+
+	_meshes.clear();
+	_models.clear();
+}
+
+GLintptr MeshRegistry::Append(Arena& arena, const void* data, GLsizeiptr size, GLsizeiptr alignment)
+{
+	GLintptr offset = (arena.size + alignment - 1) / alignment * alignment;
+
+	if (offset + size > arena.capacity)
+	{
+		GLsizeiptr capacity = glm::max(arena.capacity * 2, offset + size);
+
+		// Copied on the GPU, meshes already uploaded keep their offsets
+		GLuint grown;
+		glGenBuffers(1, &grown);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+		glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_READ_BUFFER, arena.buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, arena.size);
+		glDeleteBuffers(1, &arena.buffer);
+
+		arena.buffer = grown;
+		arena.capacity = capacity;
+
+		SetupVertexArrays();
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, arena.buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+	arena.size = offset + size;
+
+	return offset;
+}
+
+void MeshRegistry::SetupVertexArrays()
+{
+	GLState& state = GLState::Instance();
+
+	// Set Vertex Attributes, converted back to floats when fetched so the shaders do not change
+	state.BindVertexArray(_vao[VERTEX_FLOAT]);
+	state.BindBuffer(GL_ARRAY_BUFFER, _vertices[VERTEX_FLOAT].buffer);
+	state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indices.buffer);
+	glEnableVertexAttribArray(Node::attribute_position);
+	glEnableVertexAttribArray(Node::attribute_normal);
+	glVertexAttribPointer(Node::attribute_position, 3, GL_FLOAT, GL_FALSE, sizeof(VertexPositionNormal), (const GLvoid*)offsetof(VertexPositionNormal, position));
+	glVertexAttribPointer(Node::attribute_normal, 3, GL_FLOAT, GL_FALSE, sizeof(VertexPositionNormal), (const GLvoid*)offsetof(VertexPositionNormal, normal));
+
+	// Never used when the packed types are missing, so never set up either
+	if (_compact)
+	{
+		state.BindVertexArray(_vao[VERTEX_COMPACT]);
+		state.BindBuffer(GL_ARRAY_BUFFER, _vertices[VERTEX_COMPACT].buffer);
+		state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indices.buffer);
+		glEnableVertexAttribArray(Node::attribute_position);
+		glEnableVertexAttribArray(Node::attribute_normal);
+		glVertexAttribPointer(Node::attribute_position, 3, GL_HALF_FLOAT, GL_FALSE, sizeof(VertexCompact), (const GLvoid*)offsetof(VertexCompact, position));
+		glVertexAttribPointer(Node::attribute_normal, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(VertexCompact), (const GLvoid*)offsetof(VertexCompact, normal));
+
+		// Only read by the model program
+		glEnableVertexAttribArray(Node::attribute_part);
+		glVertexAttribIPointer(Node::attribute_part, 1, GL_UNSIGNED_SHORT, sizeof(VertexCompact), (const GLvoid*)offsetof(VertexCompact, part));
+	}
+
+	state.BindVertexArray(0);
+}
+
+void MeshRegistry::Pack(const std::vector<VertexPositionNormal>& vertices, std::vector<VertexCompact>& packed)
+{
+	packed.resize(vertices.size());
+
+	for (uint i = 0; i < vertices.size(); ++i)
+	{
+		const VertexPositionNormal& vertex = vertices[i];
+		VertexCompact& out = packed[i];
+
+		for (int c = 0; c < 3; ++c)
+			out.position[c] = glm::detail::toFloat16(vertex.position[c]);
+		out.part = 0;
+
+		// Two's complement in 10 bits, x in the low bits; w stays 0
+		out.normal = 0;
+		for (int c = 0; c < 3; ++c)
+		{
+			int value = int(glm::round(glm::clamp(vertex.normal[c], -1.0f, 1.0f) * 511.0f));
+			out.normal |= (GLuint(value) & 0x3FF) << (10 * c);
+		}
+	}
+}
+
+float MeshRegistry::ComputeRadius(const std::vector<VertexPositionNormal>& vertices)
+{
+	float radius = 0;
+	for (const VertexPositionNormal& vertex : vertices)
+		radius = glm::max(radius, length(vertex.position));
+	return radius;
+}
+
+MeshKey MeshRegistry::LodKey(const MeshKey& key, uint level)
+{
+	MeshKey lod = key;
+
+	switch (key.type)
+	{
+	case MESH_SPHERE:
+		// Each subdivision quadruples the triangles
+		lod.iterations = key.iterations > level ? key.iterations - level : 0;
+		break;
+	case MESH_CYLINDER:
+		lod.iterations = glm::max(key.iterations >> level, glm::min(key.iterations, 6u));
+		break;
+	default:
+		break;
+	}
+
+	return lod;
+}
+
+void MeshRegistry::Generate(const MeshKey& key, std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices)
+{
+	vertices.clear();
+	indices.clear();
+
+	switch (key.type)
+	{
+	case MESH_BOX:
+		GenerateBox(vertices);
+		break;
+	case MESH_PYRAMID:
+		GeneratePyramid(vertices);
+		break;
+	case MESH_SPHERE:
+		GenerateSphere(key.iterations, vertices, indices);
+		break;
+	case MESH_CYLINDER:
+		GenerateCylinder(key.iterations, key.height, vertices, indices);
+		break;
+	}
+}
+
+#pragma region BOX
+
+void MeshRegistry::GenerateBox(std::vector<VertexPositionNormal>& vertices)
+{
+	VertexPositionNormal box[36] = {
+		{ vec3(0, 0, 0), vec3(0, -1, 0) },
+		{ vec3(1, 0, 0), vec3(0, -1, 0) },
+		{ vec3(0, 0, 1), vec3(0, -1, 0) },
+
+		{ vec3(0, 0, 1), vec3(0, -1, 0) },
+		{ vec3(1, 0, 0), vec3(0, -1, 0) },
+		{ vec3(1, 0, 1), vec3(0, -1, 0) },
+
+
+		{ vec3(1, 0, 0), vec3(1, 0, 0) },
+		{ vec3(1, 1, 0), vec3(1, 0, 0) },
+		{ vec3(1, 0, 1), vec3(1, 0, 0) },
+
+		{ vec3(1, 0, 1), vec3(1, 0, 0) },
+		{ vec3(1, 1, 0), vec3(1, 0, 0) },
+		{ vec3(1, 1, 1), vec3(1, 0, 0) },
+
+
+		{ vec3(1, 1, 0), vec3(0, 1, 0) },
+		{ vec3(0, 1, 1), vec3(0, 1, 0) },
+		{ vec3(1, 1, 1), vec3(0, 1, 0) },
+
+		{ vec3(0, 1, 0), vec3(0, 1, 0) },
+		{ vec3(0, 1, 1), vec3(0, 1, 0) },
+		{ vec3(1, 1, 0), vec3(0, 1, 0) },
+
+
+		{ vec3(0, 1, 1), vec3(-1, 0, 0) },
+		{ vec3(0, 1, 0), vec3(-1, 0, 0) },
+		{ vec3(0, 0, 1), vec3(-1, 0, 0) },
+
+		{ vec3(0, 1, 0), vec3(-1, 0, 0) },
+		{ vec3(0, 0, 0), vec3(-1, 0, 0) },
+		{ vec3(0, 0, 1), vec3(-1, 0, 0) },
+
+
+		{ vec3(0, 0, 1), vec3(0, 0, 1) },
+		{ vec3(1, 0, 1), vec3(0, 0, 1) },
+		{ vec3(0, 1, 1), vec3(0, 0, 1) },
+
+		{ vec3(1, 0, 1), vec3(0, 0, 1) },
+		{ vec3(1, 1, 1), vec3(0, 0, 1) },
+		{ vec3(0, 1, 1), vec3(0, 0, 1) },
+
+
+		{ vec3(0, 0, 0), vec3(0, 0, -1) },
+		{ vec3(0, 1, 0), vec3(0, 0, -1) },
+		{ vec3(1, 0, 0), vec3(0, 0, -1) },
+
+		{ vec3(1, 0, 0), vec3(0, 0, -1) },
+		{ vec3(0, 1, 0), vec3(0, 0, -1) },
+		{ vec3(1, 1, 0), vec3(0, 0, -1) }
+	};
+	vertices.assign(&box[0], &box[36]);
+
+	for (uint x = 0; x < 36; x++)
+		vertices[x].position -= 0.5;
+}
+
+#pragma endregion
+
+#pragma region SPHERE
+
+// http://codingincircles.com/2009/09/geosphere-generation/
+
+void MeshRegistry::GenerateSphere(uint iterations, std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices)
+{
+	std::vector<vec3> positions;
+	std::vector<ivec3> triangles;
+
+	decimal insideExtent = cos(pi() / 5);
+	decimal sideLength = 2 * sin(pi() / 5);
+	decimal Cx = cos(pi() / 10);
+	decimal Cz = sin(pi() / 10);
+	decimal H1 = sqrt((sideLength)* (sideLength)-1);
+	decimal H2 = sqrt((insideExtent + 1) * (insideExtent + 1) - insideExtent * insideExtent);
+	decimal Y2 = 0.5f * (H2 - H1);
+	decimal Y1 = Y2 + H1;
+	decimal r = 1;
+	decimal s = sideLength;
+	decimal h = insideExtent;
+
+	//create the icosahedron
+	positions.push_back(vec3(0, Y1, 0));	//a
+	positions.push_back(vec3(0, Y2, r));	//b
+	positions.push_back(vec3(Cx, Y2, Cz));	//c
+	positions.push_back(vec3(0.5f * s, Y2, -h));	//d
+	positions.push_back(vec3(-0.5f * s, Y2, -h));	//e
+	positions.push_back(vec3(-Cx, Y2, Cz));	//f
+	positions.push_back(vec3(0, -Y2, -r));	//g
+	positions.push_back(vec3(-Cx, -Y2, -Cz));	//h
+	positions.push_back(vec3(-0.5f * s, -Y2, h));	//i
+	positions.push_back(vec3(0.5f * s, -Y2, h));	//j
+	positions.push_back(vec3(Cx, -Y2, -Cz));	//k
+	positions.push_back(vec3(0, -Y1, 0));	//l
+
+	//create the indices list
+	triangles.push_back(ivec3(0, 1, 2));
+	triangles.push_back(ivec3(0, 2, 3));
+	triangles.push_back(ivec3(0, 3, 4));
+	triangles.push_back(ivec3(0, 4, 5));
+	triangles.push_back(ivec3(0, 5, 1));
+	triangles.push_back(ivec3(1, 8, 9));
+	triangles.push_back(ivec3(9, 2, 1));
+	triangles.push_back(ivec3(2, 9, 10));
+	triangles.push_back(ivec3(10, 3, 2));
+	triangles.push_back(ivec3(3, 10, 6));
+	triangles.push_back(ivec3(6, 4, 3));
+	triangles.push_back(ivec3(4, 6, 7));
+	triangles.push_back(ivec3(7, 5, 4));
+	triangles.push_back(ivec3(5, 7, 8));
+	triangles.push_back(ivec3(8, 1, 5));
+	triangles.push_back(ivec3(11, 6, 10));
+	triangles.push_back(ivec3(11, 10, 9));
+	triangles.push_back(ivec3(11, 9, 8));
+	triangles.push_back(ivec3(11, 8, 7));
+	triangles.push_back(ivec3(11, 7, 6));
+
+	for (uint i = 0; i < iterations; ++i)
+	{
+		std::vector<ivec3> indices2(triangles.size());
+		for (ivec3 indexTriangle : triangles)
+		{
+			vec3 newVectorOne = mix(positions[indexTriangle.x], positions[indexTriangle.y], 0.5f);
+			vec3 newVectorTwo = mix(positions[indexTriangle.y], positions[indexTriangle.z], 0.5f);
+			vec3 newVectorThree = mix(positions[indexTriangle.z], positions[indexTriangle.x], 0.5f);
+			positions.push_back(newVectorOne);
+			positions.push_back(newVectorTwo);
+			positions.push_back(newVectorThree);
+
+			indices2.push_back(ivec3(indexTriangle.x, positions.size() - 3, positions.size() - 1));
+			indices2.push_back(ivec3(positions.size() - 3, indexTriangle.y, positions.size() - 2));
+			indices2.push_back(ivec3(positions.size() - 2, indexTriangle.z, positions.size() - 1));
+			indices2.push_back(ivec3(positions.size() - 3, positions.size() - 2, positions.size() - 1));
+		}
+
+		std::swap(triangles, indices2);
+	}
+
+	vertices.reserve(positions.size());
+	indices.reserve(triangles.size());
+
+	for (vec3& v : positions)
+		vertices.push_back({ normalize(v), normalize(v) });
+
+	for (ivec3& v : triangles)
+	{
+		indices.push_back(v.x);
+		indices.push_back(v.y);
+		indices.push_back(v.z);
+	}
+}
+
+#pragma endregion
+
+#pragma region CYLINDER
+
+// https://gamedev.net/forums/topic/359467-draw-cylinder-with-triangle-strips
+
+void MeshRegistry::GenerateCylinder(uint iterations, double height, std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices)
+{
+	std::vector<vec3> positions;
+	std::vector<ivec3> triangles;
+
+	decimal iter = 2*pi() / iterations;
+	decimal h = height * .5;
+
+	// Create the vertices list
+	positions.reserve(iterations * 2 + 2);
+	for (uint i = 0; i < iterations; ++i)
+		positions.push_back(vec3(.5 * cos(i * iter), h, .5 * sin(i * iter)));
+	for (uint i = 0; i < iterations; ++i)
+		positions.push_back(vec3(.5 * cos(i * iter), -h, .5 * sin(i * iter)));
+	positions.push_back(vec3(0, h, 0));
+	positions.push_back(vec3(0, -h, 0));
+
+	// Create the indices list
+	triangles.reserve(iterations * 4);
+	for (uint i = 0; i < iterations; ++i) // Sides
+	{
+		triangles.push_back(ivec3(i, i+iterations, (i+1)%iterations));
+		triangles.push_back(ivec3((i+1)%iterations + iterations, (i+1)%iterations, i+iterations));
+	}
+	for (uint i = 0; i < iterations; ++i) // Caps
+	{
+		triangles.push_back(ivec3(iterations * 2, i, (i+1)%iterations));
+		triangles.push_back(ivec3(iterations * 2 + 1, (i+1)%iterations + iterations, i+iterations));
+	}
+
+	vertices.reserve(positions.size());
+	indices.reserve(triangles.size());
+
+	for (vec3& v : positions)
+		vertices.push_back({ v + vec3(0, h, 0), normalize(v) });
+
+	for (ivec3& v : triangles)
+	{
+		indices.push_back(v.x);
+		indices.push_back(v.y);
+		indices.push_back(v.z);
+	}
+}
+
+#pragma endregion
+
+#pragma region PYRAMID
+
+void MeshRegistry::GeneratePyramid(std::vector<VertexPositionNormal>& vertices)
+{
+	VertexPositionNormal pyramid[18] = {
+		{ vec3(0, 0, 0), vec3(0, -1, 0) },
+		{ vec3(1, 0, 0), vec3(0, -1, 0) },
+		{ vec3(0, 0, 1), vec3(0, -1, 0) },
+
+		{ vec3(0, 0, 1), vec3(0, -1, 0) },
+		{ vec3(1, 0, 0), vec3(0, -1, 0) },
+		{ vec3(1, 0, 1), vec3(0, -1, 0) },
+
+
+		{ vec3( 0, 0,  0), normalize(vec3(0, .5, -1)) },
+		{ vec3( 1, 0,  0), normalize(vec3(0, .5, -1)) },
+		{ vec3(.5, 1, .5), normalize(vec3(0, .5, -1)) },
+
+		{ vec3( 0, 0,  0), normalize(vec3(-1, .5, 0)) },
+		{ vec3( 0, 0,  1), normalize(vec3(-1, .5, 0)) },
+		{ vec3(.5, 1, .5), normalize(vec3(-1, .5, 0)) },
+
+		{ vec3( 0, 0,  1), normalize(vec3(0, .5, 1)) },
+		{ vec3( 1, 0,  1), normalize(vec3(0, .5, 1)) },
+		{ vec3(.5, 1, .5), normalize(vec3(0, .5, 1)) },
+
+		{ vec3( 1, 0,  0), normalize(vec3(1, .5, 0)) },
+		{ vec3( 1, 0,  1), normalize(vec3(1, .5, 0)) },
+		{ vec3(.5, 1, .5), normalize(vec3(1, .5, 0)) }
+	};
+	vertices.assign(&pyramid[0], &pyramid[18]);
+
+	for (uint x = 0; x < 18; x++)
+		vertices[x].position -= vec3(.5, 0, .5);
+}
+
+#pragma endregion
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <main.h>
+#include <glm/gtc/half_float.hpp>
+#include <map>
+
+using namespace glm;
+
+struct VertexPositionNormal
+{
+	vec3 position;
+	vec3 normal;
+};
+
+// Half the size of VertexPositionNormal: primitives fit the unit cube, so half floats
+// keep their positions exact enough, and unit normals fit 10 bits per component
+struct VertexCompact
+{
+	glm::detail::hdata position[3];
+	GLushort part;	// Palette entry in baked models, 0 otherwise; also keeps the normal aligned
+	GLuint normal;	// GL_INT_2_10_10_10_REV, signed normalized
+};
+
+// Layout of a mesh's vertex buffer
+enum VertexFormat
+{
+	VERTEX_FLOAT,	// VertexPositionNormal
+	VERTEX_COMPACT	// VertexCompact
+};
+
+// Tessellations generated per primitive, level 0 being the finest
+#define MESH_LOD_LEVELS 3
+
+// Initial size of the shared vertex buffers and index buffer, in bytes; they double when full
+#define MESH_BUFFER_SIZE (1024*1024)
+
+// Shapes one baked model may combine, the size of the palette in vertex_model.glsl
+#define MODEL_MAX_PARTS 16
+
+enum MeshType
+{
+	MESH_BOX,
+	MESH_PYRAMID,
+	MESH_SPHERE,
+	MESH_CYLINDER
+};
+
+// Identifies one generated primitive; parameters a type does not use are left at 0
+struct MeshKey
+{
+	MeshType type;
+	uint iterations;
+	float height;
+	VertexFormat format;
+
+	bool operator<(const MeshKey& other) const
+	{
+		if (type != other.type)
+			return type < other.type;
+		if (iterations != other.iterations)
+			return iterations < other.iterations;
+		if (height != other.height)
+			return height < other.height;
+		return format < other.format;
+	}
+};
+
+// GPU copy of a primitive, shared by every shape using the same key. Its vertices and
+// indices are ranges of the registry's buffers, so every mesh of a format draws from
+// the same VAO.
+struct Mesh
+{
+	GLuint vao;
+	// Byte offset of the first index in the shared index buffer
+	GLintptr indexOffset;
+	// Added to every index; 0 when the indices were rebased at upload instead
+	GLint baseVertex;
+	GLsizei count;
+	// GL_UNSIGNED_SHORT whenever the vertices fit
+	GLenum indexType;
+	// May be VERTEX_FLOAT for a compact key when packed attributes are not supported
+	VertexFormat format;
+	// Order of creation, tells meshes sharing the VAO apart
+	uint id;
+	// Largest distance of a vertex from the origin; for models, of a part's vertex before its transform
+	float radius;
+
+	void Draw() const;
+	void DrawInstanced(GLsizei instances) const;
+};
+
+class MeshRegistry
+{
+public:
+	static MeshRegistry& Instance();
+
+	// Creates the shared buffers, before any Get
+	void Initialize();
+
+	// Generates and uploads the mesh on first request only
+	const Mesh* Get(const MeshKey& key);
+
+	// One mesh holding every part, in the compact layout with each vertex tagged with its
+	// part's index; the keys' formats are ignored. Null when packed attributes are not
+	// supported or there are more than MODEL_MAX_PARTS parts.
+	const Mesh* GetModel(const std::vector<MeshKey>& parts);
+
+	// Frees the shared buffers and VAOs, and forgets every mesh
+	void Release();
+
+	static void Generate(const MeshKey& key, std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices);
+
+	// Same primitive with fewer subdivisions or segments per level; boxes and pyramids never change
+	static MeshKey LodKey(const MeshKey& key, uint level);
+
+private:
+	MeshRegistry() : _compact(false), _baseVertex(false), _vao(), _vertices(), _indices() { }
+
+	// Static storage filled front to back; grows by copying into a larger buffer
+	struct Arena
+	{
+		GLuint buffer;
+		GLsizeiptr size, capacity;
+	};
+
+	// Stores data at the first multiple of alignment past the arena's contents, returns that offset
+	GLintptr Append(Arena& arena, const void* data, GLsizeiptr size, GLsizeiptr alignment);
+
+	// Points the VAOs at the current buffers
+	void SetupVertexArrays();
+
+	// Generates the primitive with its vertices welded and ordered for the caches
+	static void Build(const MeshKey& key, std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices);
+	// Appends the vertices, given in the format's layout, and the indices to the shared buffers
+	Mesh Upload(VertexFormat format, const void* vertices, uint vertex_count, std::vector<uint>& indices);
+
+	static void GenerateBox(std::vector<VertexPositionNormal>& vertices);
+	static void GeneratePyramid(std::vector<VertexPositionNormal>& vertices);
+	static void GenerateSphere(uint iterations, std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices);
+	static void GenerateCylinder(uint iterations, double height, std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices);
+
+	static void Pack(const std::vector<VertexPositionNormal>& vertices, std::vector<VertexCompact>& packed);
+	static float ComputeRadius(const std::vector<VertexPositionNormal>& vertices);
+
+	std::map<MeshKey, Mesh> _meshes;
+	std::map<std::vector<MeshKey>, Mesh> _models;
+
+	// Packed attributes, and base vertex draws (GL 3.2 or ARB_draw_elements_base_vertex)
+	bool _compact, _baseVertex;
+
+	// One VAO and vertex buffer per format, one index buffer shared by both
+	GLuint _vao[VERTEX_COMPACT + 1];
+	Arena _vertices[VERTEX_COMPACT + 1];
+	Arena _indices;
+};
@@ -0,0 +1,232 @@
+#include "mesh_optimizer.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+// Cache modelled by the optimizer, larger than the one measured since the scores only rank
+#define FORSYTH_CACHE_SIZE 32
+
+namespace
+{
+	struct VertexKey
+	{
+		VertexPositionNormal vertex;
+
+		bool operator<(const VertexKey& other) const
+		{
+			// Exact comparison: generators emit bit-identical duplicates
+			return std::memcmp(&vertex, &other.vertex, sizeof(VertexPositionNormal)) < 0;
+		}
+	};
+
+	float VertexScore(int cache_position, uint remaining)
+	{
+		if (remaining == 0)
+			return -1.0f;
+
+		float score = 0.0f;
+		if (cache_position >= 0)
+		{
+			// The last triangle's vertices are used anyway, do not favor them further
+			if (cache_position < 3)
+				score = 0.75f;
+			else
+				score = std::pow(1.0f - float(cache_position - 3) / (FORSYTH_CACHE_SIZE - 3), 1.5f);
+		}
+
+		// Finishing vertices with few triangles left avoids leaving them stranded
+		return score + 2.0f / std::sqrt(float(remaining));
+	}
+}
+
+void WeldVertices(std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices)
+{
+	if (indices.empty())
+	{
+		indices.resize(vertices.size());
+		for (uint i = 0; i < vertices.size(); ++i)
+			indices[i] = i;
+	}
+
+	std::map<VertexKey, uint> unique;
+	std::vector<uint> remap(vertices.size());
+	std::vector<VertexPositionNormal> welded;
+	welded.reserve(vertices.size());
+
+	for (uint i = 0; i < vertices.size(); ++i)
+	{
+		VertexKey key = { vertices[i] };
+
+		auto found = unique.insert(std::make_pair(key, uint(welded.size())));
+		if (found.second)
+			welded.push_back(vertices[i]);
+		remap[i] = found.first->second;
+	}
+
+	for (uint& index : indices)
+		index = remap[index];
+
+	vertices.swap(welded);
+}
+
+void OptimizeVertexCache(std::vector<uint>& indices, uint vertex_count)
+{
+	uint triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+		return;
+
+	// Triangles using each vertex, as ranges of one shared array
+	std::vector<uint> remaining(vertex_count, 0);
+	for (uint index : indices)
+		++remaining[index];
+
+	std::vector<uint> first(vertex_count + 1, 0);
+	for (uint v = 0; v < vertex_count; ++v)
+		first[v + 1] = first[v] + remaining[v];
+
+	std::vector<uint> adjacency(indices.size());
+	std::vector<uint> fill(first.begin(), first.end() - 1);
+	for (uint t = 0; t < triangle_count; ++t)
+		for (uint c = 0; c < 3; ++c)
+			adjacency[fill[indices[t * 3 + c]]++] = t;
+
+	std::vector<int> cache_position(vertex_count, -1);
+	std::vector<float> vertex_score(vertex_count);
+	for (uint v = 0; v < vertex_count; ++v)
+		vertex_score[v] = VertexScore(-1, remaining[v]);
+
+	std::vector<float> triangle_score(triangle_count);
+	for (uint t = 0; t < triangle_count; ++t)
+		triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+
+	std::vector<unsigned char> emitted(triangle_count, 0);
+	std::vector<uint> output;
+	output.reserve(indices.size());
+
+	std::vector<uint> cache, next_cache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	next_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+	uint scan = 0;
+	int best = -1;
+
+	for (uint emitted_count = 0; emitted_count < triangle_count; ++emitted_count)
+	{
+		// Nothing adjacent to the cache left, restart from the best remaining triangle
+		if (best < 0)
+		{
+			float best_score = -1.0f;
+			for (uint t = scan; t < triangle_count; ++t)
+			{
+				if (!emitted[t] && triangle_score[t] > best_score)
+				{
+					best_score = triangle_score[t];
+					best = t;
+				}
+			}
+
+			while (scan < triangle_count && emitted[scan])
+				++scan;
+		}
+
+		const uint* triangle = &indices[best * 3];
+		emitted[best] = 1;
+		output.insert(output.end(), triangle, triangle + 3);
+
+		// The emitted triangle no longer counts for its vertices
+		for (uint c = 0; c < 3; ++c)
+		{
+			uint v = triangle[c];
+			uint* begin = &adjacency[first[v]];
+			uint* end = begin + remaining[v];
+			*std::find(begin, end, uint(best)) = *(end - 1);
+			--remaining[v];
+		}
+
+		// Most recently used first
+		next_cache.assign(triangle, triangle + 3);
+		for (uint v : cache)
+		{
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+				next_cache.push_back(v);
+		}
+
+		// Vertices pushed out lose their cache bonus
+		for (uint i = FORSYTH_CACHE_SIZE; i < next_cache.size(); ++i)
+		{
+			cache_position[next_cache[i]] = -1;
+			vertex_score[next_cache[i]] = VertexScore(-1, remaining[next_cache[i]]);
+		}
+
+		if (next_cache.size() > FORSYTH_CACHE_SIZE)
+			next_cache.resize(FORSYTH_CACHE_SIZE);
+		cache.swap(next_cache);
+
+		for (uint i = 0; i < cache.size(); ++i)
+		{
+			cache_position[cache[i]] = i;
+			vertex_score[cache[i]] = VertexScore(i, remaining[cache[i]]);
+		}
+
+		// Only triangles touching the cache changed, the next one is picked among them
+		best = -1;
+		float best_score = -1.0f;
+		for (uint v : cache)
+		{
+			for (uint a = first[v]; a < first[v] + remaining[v]; ++a)
+			{
+				uint t = adjacency[a];
+				float score = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+				triangle_score[t] = score;
+
+				if (score > best_score)
+				{
+					best_score = score;
+					best = t;
+				}
+			}
+		}
+	}
+
+	indices.swap(output);
+}
+
+void OptimizeVertexFetch(std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices)
+{
+	std::vector<uint> remap(vertices.size(), UINT_MAX);
+	std::vector<VertexPositionNormal> ordered;
+	ordered.reserve(vertices.size());
+
+	for (uint& index : indices)
+	{
+		if (remap[index] == UINT_MAX)
+		{
+			remap[index] = ordered.size();
+			ordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	// Unreferenced vertices are dropped
+	vertices.swap(ordered);
+}
+
+float ComputeACMR(const std::vector<uint>& indices, uint vertex_count, uint cache_size)
+{
+	if (indices.size() < 3)
+		return 0.0f;
+
+	// Insertion time of each cached vertex; FIFO, hits do not refresh
+	std::vector<uint> inserted(vertex_count, UINT_MAX);
+	uint misses = 0;
+
+	for (uint index : indices)
+	{
+		if (inserted[index] != UINT_MAX && misses - inserted[index] < cache_size)
+			continue;
+
+		inserted[index] = misses++;
+	}
+
+	return float(misses) / (indices.size() / 3);
+}
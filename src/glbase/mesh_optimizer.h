@@ -0,0 +1,21 @@
+#pragma once
+
+#include "mesh.h"
+
+// Size of the FIFO post-transform cache ACMR is measured against
+#define MESH_ACMR_CACHE_SIZE 16
+
+// Merges vertices sharing both position and normal, so flat shaded faces keep their
+// own copies. Unindexed input (indices empty) gets an index list.
+void WeldVertices(std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices);
+
+// Reorders triangles for the post-transform cache, after Tom Forsyth's
+// "Linear-Speed Vertex Cache Optimisation"
+void OptimizeVertexCache(std::vector<uint>& indices, uint vertex_count);
+
+// Renumbers vertices in order of first use, so fetches walk the buffer forward
+void OptimizeVertexFetch(std::vector<VertexPositionNormal>& vertices, std::vector<uint>& indices);
+
+// Average cache miss ratio: vertices transformed per triangle through a FIFO cache,
+// between 0.5 at best for large regular meshes and 3 without any reuse
+float ComputeACMR(const std::vector<uint>& indices, uint vertex_count, uint cache_size = MESH_ACMR_CACHE_SIZE);
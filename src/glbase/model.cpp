@@ -0,0 +1,59 @@
+#include "model.h"
+#include "render_queue.h"
+
+void Model::Build(Node* root)
+{
+	_parts.clear();
+	root->Visit([this](Node& node)
+	{
+		if (Shape* shape = dynamic_cast<Shape*>(&node))
+			_parts.push_back(shape);
+	});
+
+	_mesh = nullptr;
+	for (const Mesh*& lod : _lods)
+		lod = nullptr;
+
+	if (!RenderQueue::Instance().palettes())
+		return;
+
+	std::vector<MeshKey> keys(_parts.size());
+	for (uint level = 0; level < MESH_LOD_LEVELS; ++level)
+	{
+		for (uint i = 0; i < _parts.size(); ++i)
+			keys[i] = MeshRegistry::LodKey(_parts[i]->key(), level);
+
+		_lods[level] = MeshRegistry::Instance().GetModel(keys);
+	}
+
+	_mesh = _lods[0];
+}
+
+void Model::lod(uint level)
+{
+	if (_mesh)
+		_mesh = _lods[glm::min(level, uint(MESH_LOD_LEVELS - 1))];
+}
+
+void Model::Render()
+{
+	mat4 transforms[MODEL_MAX_PARTS];
+	vec4 colors[MODEL_MAX_PARTS];
+
+	bool baked = _mesh != nullptr;
+	for (uint i = 0; baked && i < _parts.size(); ++i)
+	{
+		transforms[i] = _parts[i]->GetWorldTransform();
+		colors[i] = _parts[i]->color();
+		baked = colors[i].a >= 1;
+	}
+
+	if (baked)
+	{
+		RenderQueue::Instance().SubmitModel(_mesh, transforms, colors, _parts.size());
+		return;
+	}
+
+	for (Shape* part : _parts)
+		part->Render();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "scene.h"
+
+// Every shape of a hierarchy baked into a single mesh whose vertices know their part.
+// Drawing it takes one call and a palette with each part's world transform and color,
+// so the parts still move and color independently. The shapes are drawn one by one
+// instead when the mesh could not be baked or a part is translucent, since those
+// have to be sorted with the rest of the scene.
+class Model
+{
+public:
+	Model() : _mesh(nullptr), _lods() { }
+
+	// Collects the shapes under root, in visiting order; the hierarchy must not change afterwards
+	void Build(Node* root);
+
+	// Tessellation of the baked mesh, see Shape::lod; the shapes pick theirs on their own
+	void lod(uint level);
+
+	void Render();
+
+private:
+	std::vector<Shape*> _parts;
+
+	// Owned by the MeshRegistry, shared with every model of the same shapes
+	const Mesh* _mesh;
+	const Mesh* _lods[MESH_LOD_LEVELS];
+};
@@ -4,50 +4,59 @@
 #define X_AXIS vec3(1, 0, 0)
 #define Y_AXIS vec3(0, 1, 0)
 #define Z_AXIS vec3(0, 0, 1)
-Projectile::Projectile(const vec3 &position, const vec3 &velocity, const vec4 &color_i, const vec4 &color_o, bool friendly) :
-	_inner(1, color_i),
-	_outer(1, color_o),
-	_position(position),
-	_velocity(velocity),
-	_friendly(friendly)
+uint Entity::GetProjectileSpawnPoint(vec3* out, uint capacity)
 {
-	AddChild(&_inner);
-	_inner.AddChild(&_outer);
+	if (capacity > 0)
+		out[0] = Position + vec3(0.0f, 0.0f, 0.5f);
+	return 1;
+}
 
-	_outer.SetTransform(glm::scale(vec3(2)));
+AABB Entity::GetGlobalAABB()
+{
+	return _bounds.GetBounds();
 }
 
-void Projectile::Render()
+uint Entity::GetAABB(AABB* out, uint capacity)
 {
-	_inner.Render();
-	_outer.Render();
+	return _bounds.GetPartBoxes(out, capacity);
 }
 
-void Projectile::Update(double dt)
+bool Entity::Intersect(vec3 world_pos)
 {
-	_position += _velocity * decimal(dt);
+	return _bounds.Intersect(world_pos);
+}
 
-	SetTransform(glm::translate(_position) * scale(vec3(0.1f)));
+bool Entity::IntersectSegment(const vec3& from, const vec3& to, float& toi)
+{
+	return _bounds.IntersectSegment(from, to, toi);
 }
 
-std::vector<vec3> Entity::GetProjectileSpawnPoint()
+void Entity::IntersectSegments(const SegmentBatch& segments, std::vector<float>& toi)
 {
-	return std::vector<vec3>{Position + vec3(0.0f, 0.0f, 0.5f)};
+	_bounds.IntersectSegments(segments, toi);
 }
 
-AABB Entity::GetGlobalAABB()
+void Entity::SetLod(uint level)
 {
-	return GetGeneralAABB();
+	if (level != _lod && level < MESH_LOD_LEVELS && _root)
+	{
+		_root->Visit([level](Node& node) { node.lod(level); });
+		_model.lod(level);
+	}
+
+	_lod = level;
 }
 
-std::vector<AABB> Entity::GetAABB()
+void Entity::Render()
 {
-	return GetAABBList();
+	_model.Render();
 }
 
-bool Entity::Intersect(vec3 world_pos)
+void Entity::SetRoot(Node* root)
 {
-	return Node::Intersect(world_pos);
+	_root = root;
+	_bounds.Build(root);
+	_model.Build(root);
 }
 
 Fighter1::Fighter1(const vec3& position, const vec3& velocity, double rate_of_fire, vec3 proj_vel) : Entity(position, velocity, rate_of_fire, proj_vel)
@@ -91,18 +100,8 @@ Fighter1::Fighter1(const vec3& position, const vec3& velocity, double rate_of_fi
 		rotate(mat4(), -.5f * pi(), X_AXIS));
 	down->SetTransform(scale(vec3(1, 1, .5)) * translate(vec3(0, 1, 0)) *
 		rotate(mat4(), .5f * pi(), X_AXIS));
-}
 
-void Fighter1::Render()
-{
-	horizontal->Render();
-	vertical->Render();
-
-	center->Render();
-	left->Render();
-	right->Render();
-	up->Render();
-	down->Render();
+	SetRoot(center.get());
 }
 
 void Fighter1::Update(double dt)
@@ -115,20 +114,6 @@ void Fighter1::Update(double dt)
 		rotate(mat4(), animation * animSpeed, Y_AXIS));
 }
 
-AABB Fighter1::GetGlobalAABB()
-{
-	return center->GetGeneralAABB();
-}
-
-std::vector<AABB> Fighter1::GetAABB()
-{
-	return center->GetAABBList();
-}
-
-bool Fighter1::Intersect(vec3 world_pos)
-{
-	return center->Intersect(world_pos);
-}
 
 Fighter2::Fighter2(const vec3& position, const vec3& velocity, double rate_of_fire, vec3 proj_vel) : Entity(position, velocity, rate_of_fire, proj_vel)
 {
@@ -184,18 +169,8 @@ Fighter2::Fighter2(const vec3& position, const vec3& velocity, double rate_of_fi
 		scale(vec3(.5)) *
 		translate(vec3(0, -.75, 0))
 	);
-}
 
-void Fighter2::Render()
-{
-	center->Render();
-	top->Render();
-
-	left->Render();
-	right->Render();
-
-	backLeft->Render();
-	backRight->Render();
+	SetRoot(center.get());
 }
 
 void Fighter2::Update(double dt)
@@ -210,17 +185,3 @@ void Fighter2::Update(double dt)
 	);
 }
 
-AABB Fighter2::GetGlobalAABB()
-{
-	return center->GetGeneralAABB();
-}
-
-std::vector<AABB> Fighter2::GetAABB()
-{
-	return center->GetAABBList();
-}
-
-bool Fighter2::Intersect(vec3 world_pos)
-{
-	return center->Intersect(world_pos);
-}
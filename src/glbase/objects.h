@@ -1,30 +1,20 @@
 #pragma once
 
 #include "scene.h"
+#include "bvh.h"
+#include "model.h"
 #include <list>
 
-class Projectile : public Node
-{
-public:
-	Projectile() = delete;
-	Projectile(const vec3 &position, const vec3 &velocity, const vec4 &color_i, const vec4 &color_o, bool friendly);
-
-	virtual void Render();
-	virtual void Update(double dt);
-
-	void velocity(const vec3& v) { _velocity = v; }
-	const vec3& velocity() const { return _velocity; }
+// Upper bounds for the caller-provided buffers of the query functions below
+#define MAX_SPAWN_POINTS 8
+#define MAX_PARTS 32
 
-	void position(const vec3& p) { _position = p; }
-	const vec3& position() const { return _position; }
-
-	bool friendly() const { return _friendly; }
-protected:
-	Sphere _inner, _outer;
-
-	vec3 _position;
-	vec3 _velocity;
-	bool _friendly;
+// One impostor is captured per kind
+enum EntityKind
+{
+	ENTITY_FIGHTER1,
+	ENTITY_FIGHTER2,
+	ENTITY_KINDS
 };
 
 class Entity : public Node
@@ -38,10 +28,18 @@ public:
 		projectile_vel = proj_vel;
 	};
 
-	virtual void Render() = 0;
+	// Every part in one draw when the model could be baked
+	virtual void Render();
 	virtual void Update(double dt) = 0;
+	virtual EntityKind kind() const = 0;
+
+	uint GetLod() const { return _lod; }
+	// Switches every part to the level; the impostor level leaves them as they were. Named
+	// apart from Node::lod, which an entity leaves empty as it has no mesh of its own.
+	void SetLod(uint level);
 
-	std::vector<vec3> GetProjectileSpawnPoint();
+	// Writes up to `capacity` spawn points and returns how many there are
+	uint GetProjectileSpawnPoint(vec3* out, uint capacity);
 	vec3 Position;
 	double last_shot = 0.0f;
 	double rof = 2.0f;
@@ -49,13 +47,23 @@ public:
 	uint score;
 
 	virtual AABB GetGlobalAABB();
-	virtual std::vector<AABB> GetAABB();
+	virtual uint GetAABB(AABB* out, uint capacity);
 	virtual bool Intersect(vec3 world_pos);
+	virtual bool IntersectSegment(const vec3& from, const vec3& to, float& toi);
+	virtual void IntersectSegments(const SegmentBatch& segments, std::vector<float>& toi);
 
 protected:
 
 	vec3 _velocity;
 
+	// Builds the part bounds and the model, called by derived classes once their hierarchy is set up
+	void SetRoot(Node* root);
+
+	BoundingHierarchy _bounds;
+	Model _model;
+	Node* _root = nullptr;
+	uint _lod = 0;
+
 };
 
 class Fighter1 : public Entity
@@ -64,12 +72,8 @@ public:
 	Fighter1() = delete;
 	Fighter1(const vec3 &position, const vec3 &velocity, double rate_of_fire, vec3 proj_vel = vec3(0.0f, 0.0f, 5.0f));
 
-	virtual void Render() override;
 	virtual void Update(double dt) override;
-
-	virtual AABB GetGlobalAABB();
-	virtual std::vector<AABB> GetAABB();
-	virtual bool Intersect(vec3 world_pos);
+	virtual EntityKind kind() const override { return ENTITY_FIGHTER1; }
 
 private:
 	// Meshes
@@ -92,12 +96,8 @@ public:
 	Fighter2() = delete;
 	Fighter2(const vec3 &position, const vec3 &velocity, double rate_of_fire, vec3 proj_vel = vec3(0.0f, 0.0f, 5.0f));
 
-	virtual void Render() override;
 	virtual void Update(double dt) override;
-
-	virtual AABB GetGlobalAABB();
-	virtual std::vector<AABB> GetAABB();
-	virtual bool Intersect(vec3 world_pos);
+	virtual EntityKind kind() const override { return ENTITY_FIGHTER2; }
 
 private:
 	// Meshes
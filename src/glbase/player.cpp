@@ -125,27 +125,14 @@ Player::Player()
 	left_2_rocket_fire->SetTransform(left_2_rocket_trans);
 	right_rocket_fire->SetTransform(right_rocket_trans);
 	right_2_rocket_fire->SetTransform(right_2_rocket_trans);
+
+	bounds.Build(core.get());
+	model.Build(core.get());
 }
 
 void Player::Render()
 {
-	core->Render();
-
-	back_core->Render();
-	left_aileron->Render();
-	right_aileron->Render();
-
-	left_wing->Render();
-	left_rocket->Render();
-	left_rocket_fire->Render();
-	left_2_rocket->Render();
-	left_2_rocket_fire->Render();
-
-	right_wing->Render();
-	right_rocket->Render();
-	right_rocket_fire->Render();
-	right_2_rocket->Render();
-	right_2_rocket_fire->Render();
+	model.Render();
 }
 
 void Player::Update(double dt)
@@ -217,27 +204,42 @@ void Player::Update(double dt)
 	);
 }
 
-std::vector<glm::vec3> Player::getProjectileSpawnPoint() const
+uint Player::getProjectileSpawnPoint(vec3* out, uint capacity) const
 {
-	return {
-		Position + vec3(-1.0, +0.0, -0.5),
-		Position + vec3(+1.0, -0.0, -0.5),
-		Position + vec3(-0.0, +0.5, -0.5),
-		Position + vec3(+0.0, -0.5, -0.5),
+	const vec3 offsets[] = {
+		vec3(-1.0, +0.0, -0.5),
+		vec3(+1.0, -0.0, -0.5),
+		vec3(-0.0, +0.5, -0.5),
+		vec3(+0.0, -0.5, -0.5),
 	};
+	const uint count = sizeof offsets / sizeof offsets[0];
+
+	for (uint i = 0; i < count && i < capacity; ++i)
+		out[i] = Position + offsets[i];
+	return count;
 }
 
 AABB Player::GetGlobalAABB() const
 {
-	return core->GetGeneralAABB();
+	return bounds.GetBounds();
 }
 
-std::vector<AABB> Player::GetAABB() const
+uint Player::GetAABB(AABB* out, uint capacity) const
 {
-	return core->GetAABBList();
+	return bounds.GetPartBoxes(out, capacity);
 }
 
 bool Player::Intersect(vec3 world_pos) const
 {
-	return core->Intersect(world_pos);
+	return bounds.Intersect(world_pos);
+}
+
+bool Player::IntersectSegment(const vec3& from, const vec3& to, float& toi) const
+{
+	return bounds.IntersectSegment(from, to, toi);
+}
+
+void Player::IntersectSegments(const SegmentBatch& segments, std::vector<float>& toi) const
+{
+	bounds.IntersectSegments(segments, toi);
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include "scene.h"
 #include "objects.h"
+#include "bvh.h"
+#include "model.h"
 #include <random>
 
 class Player
@@ -18,7 +20,7 @@ public:
 	Player();
 	void Render();
 	void Update(double dt);
-	std::vector<vec3> getProjectileSpawnPoint() const;
+	uint getProjectileSpawnPoint(vec3* out, uint capacity) const;
 	uint lifes = 5;
 	int score = 0;
 
@@ -33,8 +35,10 @@ public:
 	vec3 Position = vec3(0.0f);
 
 	AABB GetGlobalAABB() const;
-	std::vector<AABB> GetAABB() const;
+	uint GetAABB(AABB* out, uint capacity) const;
 	bool Intersect(vec3 world_pos) const;
+	bool IntersectSegment(const vec3& from, const vec3& to, float& toi) const;
+	void IntersectSegments(const SegmentBatch& segments, std::vector<float>& toi) const;
 	bool god_mode = false;
 
 private:
@@ -66,6 +70,12 @@ private:
 	mat4 right_rocket_trans;
 	mat4 left_rocket_trans;
 
+	// Part bounds, refitted lazily by the const queries
+	mutable BoundingHierarchy bounds;
+
+	// Every part in one draw
+	Model model;
+
 	//Movement related
 
 	float recovery_time = 0.1f;
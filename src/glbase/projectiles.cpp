@@ -0,0 +1,156 @@
+#include "projectiles.h"
+#include "render_queue.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PROJECTILES_SSE
+#include <xmmintrin.h>
+#endif
+
+#define PROJECTILE_INNER_SCALE 0.1f
+#define PROJECTILE_OUTER_SCALE 0.2f
+
+ProjectileSystem::ProjectileSystem(float min_z, float max_z)
+	: _minZ(min_z), _maxZ(max_z), _count(0)
+{ }
+
+void ProjectileSystem::Spawn(const vec3& position, const vec3& velocity, const vec4& color_in, const vec4& color_out, bool friendly)
+{
+	uint i = _count;
+	Resize(_count + 1);
+
+	_posX[i] = _prevX[i] = position.x;
+	_posY[i] = _prevY[i] = position.y;
+	_posZ[i] = _prevZ[i] = position.z;
+	_velX[i] = velocity.x; _velY[i] = velocity.y; _velZ[i] = velocity.z;
+	_colorIn[i] = color_in;
+	_colorOut[i] = color_out;
+	_friendly[i] = friendly ? 1 : 0;
+}
+
+void ProjectileSystem::Clear()
+{
+	Resize(0);
+}
+
+void ProjectileSystem::Update(double dt)
+{
+	// Survivors are moved down to 'alive' as soon as they are integrated, which never
+	// overwrites a projectile that has not been visited yet since alive <= i
+	uint alive = 0;
+
+#ifdef PROJECTILES_SSE
+	const __m128 step = _mm_set1_ps(float(dt));
+	const __m128 minZ = _mm_set1_ps(_minZ), maxZ = _mm_set1_ps(_maxZ);
+
+	for (uint i = 0; i < _count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&_posX[i]), y = _mm_loadu_ps(&_posY[i]), z = _mm_loadu_ps(&_posZ[i]);
+		_mm_storeu_ps(&_prevX[i], x);
+		_mm_storeu_ps(&_prevY[i], y);
+		_mm_storeu_ps(&_prevZ[i], z);
+
+		// Decided on the start of the step, so the segment leaving the playfield is
+		// still swept for hits before the projectile goes
+		uint keep = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(z, minZ), _mm_cmple_ps(z, maxZ)));
+
+		x = _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(&_velX[i]), step));
+		y = _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(&_velY[i]), step));
+		z = _mm_add_ps(z, _mm_mul_ps(_mm_loadu_ps(&_velZ[i]), step));
+		_mm_storeu_ps(&_posX[i], x);
+		_mm_storeu_ps(&_posY[i], y);
+		_mm_storeu_ps(&_posZ[i], z);
+
+		// Nothing removed so far and nothing to remove here: already in place
+		if (keep == 0xF && alive == i && i + 4 <= _count)
+		{
+			alive += 4;
+			continue;
+		}
+
+		for (uint lane = 0; lane < 4 && i + lane < _count; ++lane)
+		{
+			if (keep & (1u << lane))
+				Move(i + lane, alive++);
+		}
+	}
+#else
+	const float step = float(dt);
+
+	for (uint i = 0; i < _count; ++i)
+	{
+		_prevX[i] = _posX[i]; _prevY[i] = _posY[i]; _prevZ[i] = _posZ[i];
+		_posX[i] += _velX[i] * step;
+		_posY[i] += _velY[i] * step;
+		_posZ[i] += _velZ[i] * step;
+
+		if (_prevZ[i] >= _minZ && _prevZ[i] <= _maxZ)
+			Move(i, alive++);
+	}
+#endif
+
+	Resize(alive);
+}
+
+void ProjectileSystem::Remove(const std::vector<unsigned char>& remove)
+{
+	uint alive = 0;
+	for (uint i = 0; i < _count; ++i)
+	{
+		if (!remove[i])
+			Move(i, alive++);
+	}
+
+	Resize(alive);
+}
+
+uint ProjectileSystem::Render(const Frustum& frustum)
+{
+	const Mesh* sphere = MeshRegistry::Instance().Get({ MESH_SPHERE, 1, 0, VERTEX_COMPACT });
+
+	RenderQueue& queue = RenderQueue::Instance();
+
+	// The outer shell bounds both
+	const float radius = sphere->radius * PROJECTILE_OUTER_SCALE;
+
+	uint visible = 0;
+	for (uint i = 0; i < _count; ++i)
+	{
+		vec3 position(_posX[i], _posY[i], _posZ[i]);
+		if (!frustum.Intersects(position, radius))
+			continue;
+
+		mat4 model = glm::translate(mat4(), position);
+		queue.Submit(sphere, glm::scale(model, vec3(PROJECTILE_INNER_SCALE)), _colorIn[i]);
+		queue.Submit(sphere, glm::scale(model, vec3(PROJECTILE_OUTER_SCALE)), _colorOut[i]);
+		++visible;
+	}
+
+	return visible;
+}
+
+void ProjectileSystem::Move(uint from, uint to)
+{
+	if (from == to)
+		return;
+
+	_posX[to] = _posX[from]; _posY[to] = _posY[from]; _posZ[to] = _posZ[from];
+	_prevX[to] = _prevX[from]; _prevY[to] = _prevY[from]; _prevZ[to] = _prevZ[from];
+	_velX[to] = _velX[from]; _velY[to] = _velY[from]; _velZ[to] = _velZ[from];
+	_colorIn[to] = _colorIn[from];
+	_colorOut[to] = _colorOut[from];
+	_friendly[to] = _friendly[from];
+}
+
+void ProjectileSystem::Resize(uint count)
+{
+	_count = count;
+
+	uint padded = (count + 3) & ~3u;
+	_posX.resize(padded); _posY.resize(padded); _posZ.resize(padded);
+	_prevX.resize(padded); _prevY.resize(padded); _prevZ.resize(padded);
+	_velX.resize(padded); _velY.resize(padded); _velZ.resize(padded);
+
+	_colorIn.resize(count);
+	_colorOut.resize(count);
+	_friendly.resize(count);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "scene.h"
+#include "frustum.h"
+
+// Every live projectile, stored as parallel arrays.
+// Update integrates four projectiles per SSE instruction and drops the ones that
+// started the step outside the playfield in the same pass, compacting the arrays in
+// place; the step leaving it is kept one frame so it can still be swept for hits.
+// Indices are dense and only stable until the next Update or Remove.
+class ProjectileSystem
+{
+public:
+	// Projectiles are kept while min_z <= z <= max_z
+	ProjectileSystem(float min_z, float max_z);
+
+	void Spawn(const vec3& position, const vec3& velocity, const vec4& color_in, const vec4& color_out, bool friendly);
+	void Clear();
+
+	void Update(double dt);
+
+	// Removes projectile i when remove[i] is set, keeping the others in order
+	void Remove(const std::vector<unsigned char>& remove);
+
+	uint size() const { return _count; }
+	vec3 position(uint i) const { return vec3(_posX[i], _posY[i], _posZ[i]); }
+	// Position before the last Update, for swept collision tests
+	vec3 previous(uint i) const { return vec3(_prevX[i], _prevY[i], _prevZ[i]); }
+	bool friendly(uint i) const { return _friendly[i] != 0; }
+
+	// Submits the instances of projectiles inside the frustum with the shared sphere
+	// mesh, returns how many projectiles were visible
+	uint Render(const Frustum& frustum);
+
+private:
+	void Move(uint from, uint to);
+	void Resize(uint count);
+
+	float _minZ, _maxZ;
+	uint _count;
+
+	// Padded to a multiple of 4
+	std::vector<float> _posX, _posY, _posZ;
+	std::vector<float> _prevX, _prevY, _prevZ;
+	std::vector<float> _velX, _velY, _velZ;
+
+	std::vector<vec4> _colorIn, _colorOut;
+	std::vector<unsigned char> _friendly;
+};
@@ -0,0 +1,292 @@
+#include "render_queue.h"
+#include "scene.h"
+#include "gl_state.h"
+#include "stream_buffer.h"
+#include <algorithm>
+#include <cstring>
+
+// Matrices take one location per column
+GLint RenderQueue::attribute_model = 3;
+GLint RenderQueue::attribute_color = 7;
+GLint RenderQueue::attribute_normal = 8;
+
+namespace
+{
+	// Inverse transpose of the model's linear part, up to a positive scale factor since
+	// normals are renormalized per fragment
+	mat3 NormalMatrix(const mat4& model)
+	{
+		mat3 linear(model);
+
+		// Rotation and uniform scale: the matrix itself already preserves normals
+		float xx = glm::dot(linear[0], linear[0]), yy = glm::dot(linear[1], linear[1]), zz = glm::dot(linear[2], linear[2]);
+		float tolerance = 1e-4f * xx;
+		if (glm::abs(xx - yy) <= tolerance && glm::abs(xx - zz) <= tolerance &&
+			glm::abs(glm::dot(linear[0], linear[1])) <= tolerance &&
+			glm::abs(glm::dot(linear[0], linear[2])) <= tolerance &&
+			glm::abs(glm::dot(linear[1], linear[2])) <= tolerance)
+			return linear;
+
+		// Shear and non-uniform scale
+		return glm::transpose(glm::inverse(linear));
+	}
+}
+
+RenderQueue& RenderQueue::Instance()
+{
+	static RenderQueue instance;
+	return instance;
+}
+
+void RenderQueue::InitializePreLink(GLuint instanced_program)
+{
+	Node::InitializePreLink(instanced_program);
+	glBindAttribLocation(instanced_program, attribute_model, "in_model");
+	glBindAttribLocation(instanced_program, attribute_color, "in_color");
+	glBindAttribLocation(instanced_program, attribute_normal, "in_normal_matrix");
+}
+
+void RenderQueue::InitializePostLink(GLuint program, GLuint instanced_program, GLuint model_program)
+{
+	_program = program;
+	_instancedProgram = instanced_program;
+	_modelProgram = model_program;
+	_instanced = GLEW_VERSION_3_3 || GLEW_ARB_instanced_arrays;
+
+	if (!_instanced)
+	{
+		_LOG_INFO() << "Instanced arrays not supported, shapes are drawn one by one.";
+	}
+
+	// Each model binds its own slice of one upload, which must start at an allowed offset
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	_paletteAlignment = glm::max(alignment, GLint(sizeof(InstanceData)));
+	_palettes = (MODEL_MAX_PARTS * sizeof(InstanceData)) % _paletteAlignment == 0;
+
+	if (!_palettes)
+	{
+		_LOG_INFO() << "Uniform buffer offsets aligned to " << alignment << " bytes, models are drawn part by part.";
+	}
+
+	debugGLError();
+}
+
+void RenderQueue::Submit(const Mesh* mesh, const mat4& model, const vec4& color)
+{
+	mat3 normal = NormalMatrix(model);
+	_commands.push_back({ mesh, { model, color, { vec4(normal[0], 0), vec4(normal[1], 0), vec4(normal[2], 0) } } });
+}
+
+void RenderQueue::SubmitModel(const Mesh* model, const mat4* transforms, const vec4* colors, uint parts)
+{
+	_models.push_back(model);
+
+	uint first = _palette.size();
+	_palette.resize(first + MODEL_MAX_PARTS);
+
+	for (uint i = 0; i < parts; ++i)
+	{
+		mat3 normal = NormalMatrix(transforms[i]);
+		_palette[first + i] = { transforms[i], colors[i], { vec4(normal[0], 0), vec4(normal[1], 0), vec4(normal[2], 0) } };
+	}
+}
+
+void RenderQueue::Execute(const mat4& view, const std::function<void()>& after_opaque)
+{
+	if (_commands.empty() && _models.empty())
+	{
+		if (after_opaque)
+			after_opaque();
+		return;
+	}
+
+	_drawCalls = 0;
+	_vertices = 0;
+
+	// Opaque, and usually closer and larger than the shapes, so they go first
+	if (!_models.empty())
+		DrawModels();
+
+	uint count = _commands.size();
+	_order.resize(count);
+	for (uint i = 0; i < count; ++i)
+		_order[i] = { SortKey(_commands[i], view), i };
+	std::sort(_order.begin(), _order.end());
+
+	GLState& state = GLState::Instance();
+	state.UseProgram(_instanced ? _instancedProgram : _program);
+
+	// The view is rigid, so rotating world space normals is enough to reach view space
+	mat3 view_rotation(view);
+
+	if (_instanced && count)
+	{
+		// One upload for the whole queue, in draw order
+		_upload.resize(count);
+		for (uint i = 0; i < count; ++i)
+			_upload[i] = _commands[_order[i].command].instance;
+
+		_uploadOffset = StreamBuffer::Instance().Write(_upload.data(), count * sizeof(InstanceData), sizeof(InstanceData));
+	}
+
+	int pass = -1;
+	for (uint begin = 0, end = 0; begin < count; begin = end)
+	{
+		const Command& first = _commands[_order[begin].command];
+		int translucent = int(_order[begin].key >> 63);
+
+		end = begin + 1;
+		if (_instanced)
+		{
+			while (end < count && int(_order[end].key >> 63) == translucent && _commands[_order[end].command].mesh == first.mesh)
+				++end;
+		}
+
+		if (translucent != pass)
+		{
+			if (translucent && after_opaque)
+			{
+				after_opaque();
+				// Whatever it bound, the remaining draws need the queue's program
+				state.UseProgram(_instanced ? _instancedProgram : _program);
+			}
+
+			pass = translucent;
+			if (translucent)
+			{
+				state.Blend(true);
+				state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				state.DepthMask(false);
+			}
+			else
+			{
+				state.Blend(false);
+				state.DepthMask(true);
+			}
+		}
+
+		if (_instanced)
+		{
+			DrawInstanced(first.mesh, _uploadOffset + begin * sizeof(InstanceData), end - begin);
+		}
+		else
+		{
+			glUniformMatrix4fv(Node::uniform_model, 1, GL_FALSE, glm::value_ptr(first.instance.model));
+			glUniform4fv(Node::uniform_color, 1, glm::value_ptr(first.instance.color));
+
+			const vec4* normal = first.instance.normal;
+			mat3 normal_matrix = view_rotation * mat3(vec3(normal[0]), vec3(normal[1]), vec3(normal[2]));
+			glUniformMatrix3fv(Node::uniform_normal, 1, GL_FALSE, glm::value_ptr(normal_matrix));
+			first.mesh->Draw();
+		}
+
+		++_drawCalls;
+		_vertices += first.mesh->count * (end - begin);
+	}
+
+	// Nothing translucent this frame
+	if (pass != 1 && after_opaque)
+		after_opaque();
+
+	state.Blend(false);
+	state.DepthMask(true);
+
+	_commands.clear();
+}
+
+void RenderQueue::Release()
+{
+	_instanced = false;
+	_palettes = false;
+}
+
+unsigned long long RenderQueue::SortKey(const Command& command, const mat4& view)
+{
+	const mat4& model = command.instance.model;
+
+	float depth = -(view * model[3]).z;
+	float radius = command.mesh->radius * glm::max(glm::length(vec3(model[0])), glm::max(glm::length(vec3(model[1])), glm::length(vec3(model[2]))));
+
+	// Format first so the shared VAO changes at most once per pass, then the mesh so
+	// its commands end up next to each other and merge
+	unsigned long long mesh = ((unsigned long long)command.mesh->format << 30) | (command.mesh->id & 0x3FFFFFFFu);
+	unsigned int bits;
+
+	if (command.instance.color.a < 1)
+	{
+		// Sorted by their far side, so enclosing shells such as the sky come before
+		// whatever they contain. Non-negative floats order like their bit patterns.
+		float far_depth = glm::max(depth + radius, 0.0f);
+		std::memcpy(&bits, &far_depth, sizeof(bits));
+		return (1ULL << 63) | ((unsigned long long)(~bits) << 31) | mesh;
+	}
+
+	float near_depth = glm::max(depth, 0.0f);
+	std::memcpy(&bits, &near_depth, sizeof(bits));
+	return (mesh << 32) | bits;
+}
+
+void RenderQueue::SetDivisor(GLuint attribute, GLuint divisor)
+{
+	if (GLEW_VERSION_3_3)
+		glVertexAttribDivisor(attribute, divisor);
+	else
+		glVertexAttribDivisorARB(attribute, divisor);
+}
+
+void RenderQueue::DrawInstanced(const Mesh* mesh, GLsizeiptr offset, GLsizei count)
+{
+	// The instance attributes are part of the format's VAO; they are left enabled since
+	// the regular program never reads these locations
+	GLState& state = GLState::Instance();
+	state.BindVertexArray(mesh->vao);
+	state.BindBuffer(GL_ARRAY_BUFFER, StreamBuffer::Instance().buffer());
+
+	for (GLuint column = 0; column < 4; ++column)
+	{
+		GLuint attribute = attribute_model + column;
+		glEnableVertexAttribArray(attribute);
+		glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const GLvoid*)(offset + column * sizeof(vec4)));
+		SetDivisor(attribute, 1);
+	}
+
+	glEnableVertexAttribArray(attribute_color);
+	glVertexAttribPointer(attribute_color, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const GLvoid*)(offset + sizeof(mat4)));
+	SetDivisor(attribute_color, 1);
+
+	for (GLuint column = 0; column < 3; ++column)
+	{
+		GLuint attribute = attribute_normal + column;
+		glEnableVertexAttribArray(attribute);
+		glVertexAttribPointer(attribute, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const GLvoid*)(offset + sizeof(mat4) + (1 + column) * sizeof(vec4)));
+		SetDivisor(attribute, 1);
+	}
+
+	mesh->DrawInstanced(count);
+}
+
+void RenderQueue::DrawModels()
+{
+	GLState& state = GLState::Instance();
+	state.UseProgram(_modelProgram);
+	state.Blend(false);
+	state.DepthMask(true);
+
+	// Every palette in one upload, each model then binds its slice
+	const GLsizeiptr palette_size = MODEL_MAX_PARTS * sizeof(InstanceData);
+	StreamBuffer& stream = StreamBuffer::Instance();
+	GLintptr offset = stream.Write(_palette.data(), _palette.size() * sizeof(InstanceData), _paletteAlignment);
+
+	for (uint i = 0; i < _models.size(); ++i)
+	{
+		glBindBufferRange(GL_UNIFORM_BUFFER, PALETTE_UNIFORM_BINDING, stream.buffer(), offset + i * palette_size, palette_size);
+		_models[i]->Draw();
+
+		++_drawCalls;
+		_vertices += _models[i]->count;
+	}
+
+	_models.clear();
+	_palette.clear();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "mesh.h"
+#include <functional>
+
+// Collects every shape drawn during a frame and executes them in one go.
+// Commands are sorted by pass first: opaque ones front to back, then translucent ones
+// back to front so blending composes correctly. Within a pass they are ordered by
+// vertex format and mesh, and consecutive commands sharing a mesh are merged into a single
+// instanced draw. Instancing requires GL 3.3 or ARB_instanced_arrays; without it each
+// command is drawn on its own with the regular shape program, still in sorted order.
+// Baked models are opaque and drawn first, one call each with their own program.
+class RenderQueue
+{
+public:
+	static RenderQueue& Instance();
+
+	static void InitializePreLink(GLuint instanced_program);
+	void InitializePostLink(GLuint program, GLuint instanced_program, GLuint model_program);
+
+	bool instanced() const { return _instanced; }
+	// Whether SubmitModel may be used
+	bool palettes() const { return _palettes; }
+
+	void Submit(const Mesh* mesh, const mat4& model, const vec4& color);
+	// A mesh from MeshRegistry::GetModel, part i placed by transforms[i] and colored by colors[i]
+	void SubmitModel(const Mesh* model, const mat4* transforms, const vec4* colors, uint parts);
+
+	// Sorts and draws every pending command, then empties the queue.
+	// Camera matrices come from the Frame uniform block, the view is only used to sort
+	// and to bring normal matrices to view space when drawing without instancing.
+	// after_opaque runs between the two passes, for draws that must be blended over.
+	void Execute(const mat4& view, const std::function<void()>& after_opaque = std::function<void()>());
+
+	// Forgets the capabilities found by InitializePostLink
+	void Release();
+
+	// Draws issued by the last Execute that had anything to draw
+	uint draw_calls() const { return _drawCalls; }
+	// Vertices drawn by the last Execute, indices for indexed meshes
+	uint vertices() const { return _vertices; }
+
+	static GLint attribute_model, attribute_color, attribute_normal;
+
+private:
+	RenderQueue() : _instanced(false), _palettes(false), _program(0), _instancedProgram(0), _modelProgram(0),
+		_paletteAlignment(0), _uploadOffset(0), _drawCalls(0), _vertices(0) { }
+
+	// Also one entry of a model's palette, laid out like the Part struct of vertex_model.glsl
+	struct InstanceData
+	{
+		mat4 model;
+		vec4 color;
+		// World space normal matrix, columns padded to vec4
+		vec4 normal[3];
+	};
+
+	struct Command
+	{
+		const Mesh* mesh;
+		InstanceData instance;
+	};
+
+	struct SortEntry
+	{
+		unsigned long long key;
+		uint command;
+
+		bool operator<(const SortEntry& other) const { return key < other.key; }
+	};
+
+	static unsigned long long SortKey(const Command& command, const mat4& view);
+
+	void SetDivisor(GLuint attribute, GLuint divisor);
+	void DrawInstanced(const Mesh* mesh, GLsizeiptr offset, GLsizei count);
+	void DrawModels();
+
+	bool _instanced, _palettes;
+	GLuint _program, _instancedProgram, _modelProgram;
+	// Offset alignment of the palettes in the stream buffer
+	GLint _paletteAlignment;
+	// Where this frame's instances start in the stream buffer
+	GLintptr _uploadOffset;
+
+	// Emptied by Execute but never shrunk, so steady frames do not allocate
+	std::vector<Command> _commands;
+	std::vector<SortEntry> _order;
+	std::vector<InstanceData> _upload;
+
+	// MODEL_MAX_PARTS palette entries per model, the unused ones left as they are
+	std::vector<const Mesh*> _models;
+	std::vector<InstanceData> _palette;
+
+	uint _drawCalls;
+	uint _vertices;
+};
@@ -1,19 +1,52 @@
 #pragma once
 
 #include <main.h>
+#include "hierarchy.h"
+#include "mesh.h"
+#include "shader_program.h"
 
 using namespace glm;
 
-struct VertexPositionNormal
-{
-	vec3 position;
-	vec3 normal;
-};
-
 struct AABB
 {
 	vec3 min;
 	vec3 max;
+
+	bool Contains(const vec3& p) const
+	{
+		return min.x < p.x && max.x > p.x &&
+			min.y < p.y && max.y > p.y &&
+			min.z < p.z && max.z > p.z;
+	}
+
+	// Slab test of the segment [from, to]; `t` receives the entry point as a fraction of the segment
+	bool IntersectSegment(const vec3& from, const vec3& to, float& t) const
+	{
+		vec3 d = to - from;
+		float enter = 0, exit = 1;
+		for (int i = 0; i < 3; ++i)
+		{
+			if (glm::abs(d[i]) < 1e-8f)
+			{
+				if (from[i] < min[i] || from[i] > max[i])
+					return false;
+				continue;
+			}
+
+			float t0 = (min[i] - from[i]) / d[i];
+			float t1 = (max[i] - from[i]) / d[i];
+			if (t0 > t1)
+				std::swap(t0, t1);
+
+			enter = glm::max(enter, t0);
+			exit = glm::min(exit, t1);
+			if (enter > exit)
+				return false;
+		}
+
+		t = enter;
+		return true;
+	}
 };
 
 
@@ -21,17 +54,41 @@ class Node
 {
 public:
 	static void InitializePreLink(GLuint program);
-	static void InitializePostLink(GLuint program);
+	static void InitializePostLink(const ShaderProgram& program);
 
 	Node();
+	Node(const Node& other);
+	virtual ~Node();
+
 	void SetTransform(const mat4 &transform);
+	mat4 GetTransform() const;
 	void AddChild(Node *child);
+	const std::vector<Node*>& children() const { return _children; }
+	uint TransformVersion() const;
+	// Changes whenever a world matrix of the tree holding the node is recomputed
+	uint TreeRevision() const;
+	mat4 GetWorldTransform() const { return fullTransform(); }
+
+	// Picks the tessellation to draw with; only shapes have one
+	virtual void lod(uint /*level*/) { }
 
 	AABB GetFullBoundingBox();
 	bool Intersect(vec3 world_pos);
-	std::vector<AABB> GetAABBList();
 	AABB GetGeneralAABB();
 
+	// Writes the bounding box of every node of the subtree, without allocating.
+	// Returns the number of nodes in the subtree; only the first `capacity` boxes are written.
+	uint GetAABBList(AABB* out, uint capacity);
+
+	// Calls visitor(Node&) on every node of the subtree, parents first
+	template<typename Visitor>
+	void Visit(Visitor&& visitor)
+	{
+		visitor(*this);
+		for (Node* child : _children)
+			child->Visit(visitor);
+	}
+
 protected:
 
 	const vec3 boundaries[8] = {
@@ -47,13 +104,18 @@ protected:
 
 	glm::mat4 fullTransform() const;
 
-	mat4 _transform;
+	// Matrices are owned by the TransformHierarchy, the node only keeps its handle
+	TransformHierarchy::Handle _node;
 	std::vector<Node*> _children;
 	Node* _parent;
 
-	static GLint uniform_model, uniform_color;
-	static GLint attribute_position, attribute_normal;
+	static GLint uniform_model, uniform_color, uniform_normal;
+	static GLint attribute_position, attribute_normal, attribute_part;
+
+	friend class MeshRegistry;
+	friend class RenderQueue;
 
+	bool IntersectParts(const vec3& world_pos);
 	void ComputeBoundingBox();
 	AABB _boundingBox;
 };
@@ -62,55 +124,48 @@ class Shape : public Node
 {
 public:
 	virtual void Render();
-	virtual ~Shape();
 
 	void color(const vec4& v) { _color = v; }
 	const vec4& color() const { return _color; }
 
-	Shape() = default;
-	Shape(const Shape& other);
+	void lod(uint level) override { _mesh = _lods[glm::min(level, uint(MESH_LOD_LEVELS - 1))]; }
 
+	// Primitive at the finest level
+	const MeshKey& key() const { return _key; }
 
 protected:
+	Shape(const MeshKey& key, const vec4& color);
 
-
-	GLuint _vertexBuffer, _indexBuffer, _vao;
+	// Owned by the MeshRegistry, shared with every shape of the same kind
+	const Mesh* _mesh;
+	const Mesh* _lods[MESH_LOD_LEVELS];
 	vec4 _color;
-	std::vector<VertexPositionNormal> _vertices;
-	std::vector<uint> _indices;
-
-
-
+	MeshKey _key;
 };
 
+// Primitives use the compact vertex layout unless asked otherwise, e.g. for shapes
+// scaled up so much that half float positions would show
+
 class Box : public Shape
 {
 public:
-	Box(vec4 color);
-
-	virtual void Render() override;
+	Box(vec4 color, VertexFormat format = VERTEX_COMPACT);
 };
 
 class Sphere : public Shape
 {
 public:
-	Sphere(uint iterations, vec4 color);
-
-	virtual void Render() override;
+	Sphere(uint iterations, vec4 color, VertexFormat format = VERTEX_COMPACT);
 };
 
 class Cylinder : public Shape
 {
 public:
-	Cylinder(uint iterations, vec4 color, double height);
-	virtual void Render() override;
-private:
-	int vertices_count = 0;
+	Cylinder(uint iterations, vec4 color, double height, VertexFormat format = VERTEX_COMPACT);
 };
 
 class Pyramid : public Shape
 {
 public:
-	Pyramid(vec4 color);
-	virtual void Render() override;
-};
\ No newline at end of file
+	Pyramid(vec4 color, VertexFormat format = VERTEX_COMPACT);
+};
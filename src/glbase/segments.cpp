@@ -0,0 +1,112 @@
+#include "segments.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SEGMENTS_SSE
+#include <xmmintrin.h>
+#endif
+
+// Stands in for 1/0 so that no lane ever computes 0 * inf
+#define SEGMENTS_HUGE 1e30f
+
+namespace
+{
+	float SafeInverse(float d)
+	{
+		if (glm::abs(d) < 1e-8f)
+			return d < 0 ? -SEGMENTS_HUGE : SEGMENTS_HUGE;
+		return 1.0f / d;
+	}
+}
+
+SegmentBatch::SegmentBatch()
+	: _count(0)
+{ }
+
+void SegmentBatch::Clear()
+{
+	_count = 0;
+	_fromX.clear(); _fromY.clear(); _fromZ.clear();
+	_invX.clear(); _invY.clear(); _invZ.clear();
+	_from.clear(); _to.clear();
+}
+
+void SegmentBatch::Add(const vec3& from, const vec3& to)
+{
+	// Overwrite the padding lanes left by the previous Add
+	_fromX.resize(_count); _fromY.resize(_count); _fromZ.resize(_count);
+	_invX.resize(_count); _invY.resize(_count); _invZ.resize(_count);
+
+	vec3 d = to - from;
+	_fromX.push_back(from.x); _fromY.push_back(from.y); _fromZ.push_back(from.z);
+	_invX.push_back(SafeInverse(d.x)); _invY.push_back(SafeInverse(d.y)); _invZ.push_back(SafeInverse(d.z));
+	_from.push_back(from);
+	_to.push_back(to);
+	++_count;
+
+	// A segment starting far away and pointing further away misses every box
+	while (_fromX.size() % 4 != 0)
+	{
+		_fromX.push_back(SEGMENTS_HUGE); _fromY.push_back(SEGMENTS_HUGE); _fromZ.push_back(SEGMENTS_HUGE);
+		_invX.push_back(SEGMENTS_HUGE); _invY.push_back(SEGMENTS_HUGE); _invZ.push_back(SEGMENTS_HUGE);
+	}
+}
+
+void SegmentBatch::Intersect(const AABB* boxes, uint box_count, std::vector<uint>& masks) const
+{
+	uint words = MaskWords();
+	masks.assign(box_count * words, 0);
+	if (_count == 0)
+		return;
+
+	for (uint b = 0; b < box_count; ++b)
+	{
+		const AABB& box = boxes[b];
+		uint* mask = &masks[b * words];
+
+#ifdef SEGMENTS_SSE
+		const __m128 minX = _mm_set1_ps(box.min.x), minY = _mm_set1_ps(box.min.y), minZ = _mm_set1_ps(box.min.z);
+		const __m128 maxX = _mm_set1_ps(box.max.x), maxY = _mm_set1_ps(box.max.y), maxZ = _mm_set1_ps(box.max.z);
+
+		for (uint i = 0; i < _count; i += 4)
+		{
+			__m128 enter = _mm_setzero_ps();
+			__m128 exit = _mm_set1_ps(1.0f);
+
+			__m128 from = _mm_loadu_ps(&_fromX[i]), inv = _mm_loadu_ps(&_invX[i]);
+			__m128 t0 = _mm_mul_ps(_mm_sub_ps(minX, from), inv), t1 = _mm_mul_ps(_mm_sub_ps(maxX, from), inv);
+			enter = _mm_max_ps(enter, _mm_min_ps(t0, t1));
+			exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+
+			from = _mm_loadu_ps(&_fromY[i]); inv = _mm_loadu_ps(&_invY[i]);
+			t0 = _mm_mul_ps(_mm_sub_ps(minY, from), inv); t1 = _mm_mul_ps(_mm_sub_ps(maxY, from), inv);
+			enter = _mm_max_ps(enter, _mm_min_ps(t0, t1));
+			exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+
+			from = _mm_loadu_ps(&_fromZ[i]); inv = _mm_loadu_ps(&_invZ[i]);
+			t0 = _mm_mul_ps(_mm_sub_ps(minZ, from), inv); t1 = _mm_mul_ps(_mm_sub_ps(maxZ, from), inv);
+			enter = _mm_max_ps(enter, _mm_min_ps(t0, t1));
+			exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+
+			uint bits = _mm_movemask_ps(_mm_cmple_ps(enter, exit));
+			mask[i / 32] |= bits << (i % 32);
+		}
+#else
+		for (uint i = 0; i < _count; ++i)
+		{
+			float enter = 0, exit = 1;
+			const float from[3] = { _fromX[i], _fromY[i], _fromZ[i] };
+			const float inv[3] = { _invX[i], _invY[i], _invZ[i] };
+			for (int a = 0; a < 3; ++a)
+			{
+				float t0 = (box.min[a] - from[a]) * inv[a];
+				float t1 = (box.max[a] - from[a]) * inv[a];
+				enter = glm::max(enter, glm::min(t0, t1));
+				exit = glm::min(exit, glm::max(t0, t1));
+			}
+
+			if (enter <= exit)
+				mask[i / 32] |= 1u << (i % 32);
+		}
+#endif
+	}
+}
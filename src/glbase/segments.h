@@ -0,0 +1,34 @@
+#pragma once
+
+#include "scene.h"
+
+// Structure-of-arrays batch of segments, tested together against a list of boxes.
+// Uses SSE when available, four segments per instruction, with a scalar fallback.
+class SegmentBatch
+{
+public:
+	SegmentBatch();
+
+	void Clear();
+	void Add(const vec3& from, const vec3& to);
+
+	uint size() const { return _count; }
+	const vec3& from(uint i) const { return _from[i]; }
+	const vec3& to(uint i) const { return _to[i]; }
+
+	// Number of 32-bit mask words per box
+	uint MaskWords() const { return (_count + 31) / 32; }
+
+	// For every box, sets bit (i % 32) of masks[box * MaskWords() + i / 32] when segment i overlaps it
+	void Intersect(const AABB* boxes, uint box_count, std::vector<uint>& masks) const;
+
+private:
+	uint _count;
+
+	// Padded to a multiple of 4 with segments that can never hit
+	std::vector<float> _fromX, _fromY, _fromZ;
+	std::vector<float> _invX, _invY, _invZ;
+
+	// Unpadded copies for exact follow-up tests
+	std::vector<vec3> _from, _to;
+};
@@ -0,0 +1,87 @@
+#include "shader_program.h"
+
+void ShaderProgram::Create(const char* vertex_path, const char* fragment_path)
+{
+	_id = glCreateProgram();
+
+	GLuint vs = loadShader(vertex_path, GL_VERTEX_SHADER);
+	GLuint fs = loadShader(fragment_path, GL_FRAGMENT_SHADER);
+
+	glAttachShader(_id, vs);
+	glAttachShader(_id, fs);
+}
+
+void ShaderProgram::Link(const char* name)
+{
+	GLint link_ok = GL_FALSE;
+
+	glLinkProgram(_id);
+	glGetProgramiv(_id, GL_LINK_STATUS, &link_ok);
+	if (!link_ok)
+	{
+		GLint maxLength = 0;
+		glGetProgramiv(_id, GL_INFO_LOG_LENGTH, &maxLength);
+		if (maxLength == 0)
+		{
+			_LOG_CRIT() << "Could not link " << name << " shader: No errors reported." << std::endl;
+		}
+
+		{
+			std::vector<GLchar> link_error((unsigned int)maxLength + 1);
+			glGetProgramInfoLog(_id, maxLength, &maxLength, link_error.data());
+			_LOG_CRIT() << "Could not link " << name << " shader: " << std::endl << link_error.data() << std::endl;
+		}
+	}
+
+	// Reflect every active uniform outside of blocks
+	_uniforms.clear();
+
+	GLint count = 0, maxNameLength = 0;
+	glGetProgramiv(_id, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<GLchar> buffer((unsigned int)maxNameLength + 1);
+	for (GLint i = 0; i < count; ++i)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(_id, (GLuint)i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+
+		std::string uniform(buffer.data(), length);
+		GLint location = glGetUniformLocation(_id, uniform.c_str());
+		if (location < 0)
+			continue;
+
+		// Arrays are reported as "name[0]", also accept the bare name
+		if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+			uniform.resize(uniform.size() - 3);
+
+		_uniforms[uniform] = location;
+	}
+
+	GLuint frame = glGetUniformBlockIndex(_id, "Frame");
+	if (frame != GL_INVALID_INDEX)
+		glUniformBlockBinding(_id, frame, FRAME_UNIFORM_BINDING);
+
+	GLuint palette = glGetUniformBlockIndex(_id, "Palette");
+	if (palette != GL_INVALID_INDEX)
+		glUniformBlockBinding(_id, palette, PALETTE_UNIFORM_BINDING);
+
+	debugGLError();
+}
+
+void ShaderProgram::Release()
+{
+	if (_id != 0)
+		glDeleteProgram(_id);
+
+	_id = 0;
+	_uniforms.clear();
+}
+
+GLint ShaderProgram::Uniform(const std::string& name) const
+{
+	auto found = _uniforms.find(name);
+	return found != _uniforms.end() ? found->second : -1;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <main.h>
+#include <map>
+#include <string>
+
+// Binding point of the "Frame" uniform block, shared by every program
+#define FRAME_UNIFORM_BINDING 0
+// Binding point of the "Palette" uniform block, the parts of the baked model being drawn
+#define PALETTE_UNIFORM_BINDING 1
+
+// Contents of the std140 "Frame" uniform block, filled once per frame
+struct FrameUniforms
+{
+	glm::mat4 projection;
+	glm::mat4 view;
+	glm::mat4 view_projection;
+	glm::vec4 viewport;	// width, height, 1 / width, 1 / height
+	glm::vec4 time;		// seconds since start, seconds since last frame
+};
+
+// GL program whose active uniforms are reflected once, right after linking.
+// Locations are meant to be looked up by name during initialization and kept, so the
+// frame loop never performs a string lookup.
+class ShaderProgram
+{
+public:
+	ShaderProgram() : _id(0) { }
+
+	// Compiles and attaches both stages; bind attribute locations before Link
+	void Create(const char* vertex_path, const char* fragment_path);
+	// Links, reflects the uniforms and attaches the Frame and Palette blocks if the program uses them
+	void Link(const char* name);
+
+	void Release();
+
+	GLuint id() const { return _id; }
+
+	// -1 if the program has no such active uniform
+	GLint Uniform(const std::string& name) const;
+
+private:
+	ShaderProgram(const ShaderProgram&) = delete;
+	ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+	GLuint _id;
+	std::map<std::string, GLint> _uniforms;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <main.h>
+
+// Generational slot map.
+// Values are stored densely and iterated like a vector; removal swaps the last value
+// into the hole, so it is O(1) but does not preserve order. Handles stay valid across
+// other insertions and removals, and a stale handle is detected by its generation.
+template<typename T>
+class SlotMap
+{
+public:
+	struct Handle
+	{
+		glm::uint index;
+		glm::uint generation;
+	};
+
+	typedef typename std::vector<T>::iterator iterator;
+	typedef typename std::vector<T>::const_iterator const_iterator;
+
+	SlotMap() : _freeHead(NONE) { }
+
+	Handle Insert(T value)
+	{
+		glm::uint index;
+		if (_freeHead != NONE)
+		{
+			index = _freeHead;
+			_freeHead = _slots[index].dense;
+		}
+		else
+		{
+			index = _slots.size();
+			_slots.push_back({ NONE, 0 });
+		}
+
+		_slots[index].dense = _values.size();
+		_values.push_back(std::move(value));
+		_owners.push_back(index);
+
+		return { index, _slots[index].generation };
+	}
+
+	bool Contains(Handle handle) const
+	{
+		return handle.index < _slots.size() && _slots[handle.index].generation == handle.generation;
+	}
+
+	T* Get(Handle handle)
+	{
+		return Contains(handle) ? &_values[_slots[handle.index].dense] : nullptr;
+	}
+
+	void Remove(Handle handle)
+	{
+		if (Contains(handle))
+			RemoveAt(_slots[handle.index].dense);
+	}
+
+	// Removes by dense position; the last value moves into `dense`
+	void RemoveAt(glm::uint dense)
+	{
+		glm::uint index = _owners[dense];
+		glm::uint last = _values.size() - 1;
+
+		if (dense != last)
+		{
+			_values[dense] = std::move(_values[last]);
+			_owners[dense] = _owners[last];
+			_slots[_owners[dense]].dense = dense;
+		}
+		_values.pop_back();
+		_owners.pop_back();
+
+		// Bumping the generation invalidates every outstanding handle to this slot
+		++_slots[index].generation;
+		_slots[index].dense = _freeHead;
+		_freeHead = index;
+	}
+
+	void Clear()
+	{
+		for (glm::uint dense = _values.size(); dense-- > 0;)
+			RemoveAt(dense);
+	}
+
+	Handle HandleAt(glm::uint dense) const
+	{
+		glm::uint index = _owners[dense];
+		return { index, _slots[index].generation };
+	}
+
+	glm::uint size() const { return _values.size(); }
+	bool empty() const { return _values.empty(); }
+
+	T& operator[](glm::uint dense) { return _values[dense]; }
+	const T& operator[](glm::uint dense) const { return _values[dense]; }
+
+	iterator begin() { return _values.begin(); }
+	iterator end() { return _values.end(); }
+	const_iterator begin() const { return _values.begin(); }
+	const_iterator end() const { return _values.end(); }
+
+private:
+	static const glm::uint NONE = UINT_MAX;
+
+	struct Slot
+	{
+		glm::uint dense;		// Next free slot while unused
+		glm::uint generation;
+	};
+
+	std::vector<Slot> _slots;
+	std::vector<T> _values;
+	std::vector<glm::uint> _owners;	// Dense position -> slot
+	glm::uint _freeHead;
+};
@@ -0,0 +1,136 @@
+#include "stream_buffer.h"
+#include "gl_state.h"
+#include <cstring>
+
+// How long a single wait on a fence may block before trying again, in nanoseconds
+#define STREAM_WAIT_TIMEOUT 1000000000ULL
+
+StreamBuffer& StreamBuffer::Instance()
+{
+	static StreamBuffer instance;
+	return instance;
+}
+
+void StreamBuffer::Initialize(GLsizeiptr frame_size)
+{
+	_fenced = GLEW_VERSION_3_2 || GLEW_ARB_sync;
+	if (!_fenced)
+	{
+		_LOG_INFO() << "Sync objects not supported, streamed data orphans its buffer instead.";
+	}
+
+	for (GLsync& fence : _fences)
+		fence = nullptr;
+
+	glGenBuffers(1, &_buffer);
+	Allocate(frame_size);
+
+	debugGLError();
+}
+
+void StreamBuffer::Release()
+{
+	for (GLsync& fence : _fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	if (_buffer != BAD_BUFFER)
+		glDeleteBuffers(1, &_buffer);
+
+	_buffer = BAD_BUFFER;
+}
+
+void StreamBuffer::BeginFrame()
+{
+	_region = (_region + 1) % STREAM_FRAMES;
+	_head = 0;
+
+	if (!_fenced)
+	{
+		// Previous contents stay alive for pending draws, new writes get fresh storage
+		if (_region == 0)
+		{
+			GLState::Instance().BindBuffer(GL_ARRAY_BUFFER, _buffer);
+			glBufferData(GL_ARRAY_BUFFER, _frameSize * STREAM_FRAMES, nullptr, GL_STREAM_DRAW);
+		}
+		return;
+	}
+
+	GLsync& fence = _fences[_region];
+	if (!fence)
+		return;
+
+	while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_WAIT_TIMEOUT) == GL_TIMEOUT_EXPIRED)
+		continue;
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+	if (!_fenced)
+		return;
+
+	GLsync& fence = _fences[_region];
+	if (fence)
+		glDeleteSync(fence);
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+GLintptr StreamBuffer::Write(const void* data, GLsizeiptr size, GLsizeiptr alignment)
+{
+	// Aligned within the whole buffer, so offsets divide evenly by a vertex stride
+	GLintptr base = _region * _frameSize;
+	GLsizeiptr start = (base + _head + alignment - 1) / alignment * alignment - base;
+
+	if (start + size > _frameSize)
+	{
+		// Only happens when a frame outgrows every previous one. Draws already issued
+		// keep reading the old storage, the frame continues at the start of the new one.
+		GLsizeiptr frame_size = _frameSize;
+		while (frame_size < size + alignment)
+			frame_size *= 2;
+
+		_LOG_INFO() << "Stream buffer grown to " << frame_size * 2 * STREAM_FRAMES << " bytes.";
+		Allocate(frame_size * 2);
+		base = 0;
+		start = 0;
+	}
+
+	GLintptr offset = base + start;
+
+	GLState::Instance().BindBuffer(GL_ARRAY_BUFFER, _buffer);
+
+	// Nothing in flight uses this range, the driver does not need to synchronize
+	void* target = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (target)
+	{
+		std::memcpy(target, data, size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+
+	_head = start + size;
+	return offset;
+}
+
+void StreamBuffer::Allocate(GLsizeiptr frame_size)
+{
+	_frameSize = frame_size;
+	_region = 0;
+	_head = 0;
+
+	// The new storage is not used by any pending draw
+	for (GLsync& fence : _fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	GLState::Instance().BindBuffer(GL_ARRAY_BUFFER, _buffer);
+	glBufferData(GL_ARRAY_BUFFER, _frameSize * STREAM_FRAMES, nullptr, GL_STREAM_DRAW);
+}
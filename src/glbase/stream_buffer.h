@@ -0,0 +1,50 @@
+#pragma once
+
+#include <main.h>
+
+// Frames the GPU may still be reading from while the CPU writes the next one
+#define STREAM_FRAMES 3
+
+// Initial room for one frame of streamed data, in bytes; grows if a frame needs more
+#define STREAM_FRAME_SIZE (4 * 1024 * 1024)
+
+// One large vertex buffer holding every piece of per-frame data.
+// The storage is split into one region per frame in flight, used as a ring: writes
+// are appended to the current frame's region through unsynchronized maps, and a
+// fence placed at the end of each frame tells when its region can be reused. Without
+// sync objects the whole buffer is orphaned each time the ring wraps instead.
+class StreamBuffer
+{
+public:
+	static StreamBuffer& Instance();
+
+	void Initialize(GLsizeiptr frame_size);
+
+	void Release();
+
+	GLuint buffer() const { return _buffer; }
+
+	// Moves to the next region, waiting for the GPU to be done with it if needed
+	void BeginFrame();
+	// Fences everything written during the frame
+	void EndFrame();
+
+	// Copies size bytes at a multiple of alignment and returns their offset in buffer().
+	// The offset is aligned from the start of the buffer, so with the vertex stride as the
+	// alignment a draw can start at offset / stride from attributes pointed at offset 0.
+	// Leaves the buffer bound to GL_ARRAY_BUFFER.
+	GLintptr Write(const void* data, GLsizeiptr size, GLsizeiptr alignment);
+
+private:
+	StreamBuffer() : _buffer(BAD_BUFFER), _frameSize(0), _region(0), _head(0), _fenced(false) { }
+
+	void Allocate(GLsizeiptr frame_size);
+
+	GLuint _buffer;
+	GLsizeiptr _frameSize;
+	uint _region;
+	GLsizeiptr _head;
+
+	bool _fenced;
+	GLsync _fences[STREAM_FRAMES];
+};
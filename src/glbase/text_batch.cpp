@@ -0,0 +1,77 @@
+#include "text_batch.h"
+
+// Frames a layout may go unused before it is evicted
+#define TEXT_CACHE_LIFETIME 120
+
+void TextBatch::Add(const char* text, const vec2& position, const vec4& color, const vec2& letter_size, float anchor)
+{
+	Key key = { text, letter_size, anchor };
+
+	auto found = _cache.find(key);
+	if (found == _cache.end())
+	{
+		found = _cache.insert(std::make_pair(key, Run())).first;
+		Layout(key.text, letter_size, anchor, found->second.vertices);
+	}
+
+	Run& run = found->second;
+	run.lastUsed = _frame;
+
+	for (const TextVertex& vertex : run.vertices)
+		_vertices.push_back({ vertex.position + position, vertex.uv, color });
+}
+
+void TextBatch::Clear()
+{
+	_vertices.clear();
+	++_frame;
+
+	if (_frame % TEXT_CACHE_LIFETIME != 0)
+		return;
+
+	for (auto run = _cache.begin(); run != _cache.end();)
+	{
+		if (_frame - run->second.lastUsed > TEXT_CACHE_LIFETIME)
+			run = _cache.erase(run);
+		else
+			++run;
+	}
+}
+
+void TextBatch::Layout(const std::string& text, const vec2& letter_size, float anchor, std::vector<TextVertex>& out)
+{
+	float letter_w = letter_size.x;
+	float letter_h = letter_size.y;
+
+	vec2 origin(-anchor * text.size() * letter_w, 0.0f);
+
+	out.clear();
+	out.reserve(text.size() * 6);
+
+	for (unsigned int i = 0; i < text.size(); i++)
+	{
+		vec2 vertex_up_left = vec2(origin.x + i*letter_w, origin.y + letter_h);
+		vec2 vertex_up_right = vec2(origin.x + i*letter_w + letter_w, origin.y + letter_h);
+		vec2 vertex_down_right = vec2(origin.x + i*letter_w + letter_w, origin.y);
+		vec2 vertex_down_left = vec2(origin.x + i*letter_w, origin.y);
+
+		const float xd = 16.0f, yd = 8.0f;
+
+		char character = text[i] - '!' + 1;
+		float uv_x = (character % 16) / xd;
+		float uv_y = (character / 16) / yd;
+
+		vec2 uv_up_left = vec2(uv_x, 1.0f - uv_y);
+		vec2 uv_up_right = vec2(uv_x + 1.0f / xd, 1.0f - uv_y);
+		vec2 uv_down_right = vec2(uv_x + 1.0f / xd, 1.0f - (uv_y + 1.0f / yd));
+		vec2 uv_down_left = vec2(uv_x, 1.0f - (uv_y + 1.0f / yd));
+
+		out.push_back({ vertex_up_left, uv_up_left, vec4() });
+		out.push_back({ vertex_down_left, uv_down_left, vec4() });
+		out.push_back({ vertex_up_right, uv_up_right, vec4() });
+
+		out.push_back({ vertex_down_right, uv_down_right, vec4() });
+		out.push_back({ vertex_up_right, uv_up_right, vec4() });
+		out.push_back({ vertex_down_left, uv_down_left, vec4() });
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <main.h>
+#include <map>
+#include <string>
+#include <cstddef>
+
+using namespace glm;
+
+// Interleaved vertex of the text stream
+struct TextVertex
+{
+	vec2 position;
+	vec2 uv;
+	vec4 color;
+};
+
+// Collects every string drawn during a frame into one vertex stream, drawn at once.
+// Glyph quads are laid out once per distinct text, letter size and alignment and kept
+// in a cache; drawing a string seen before only copies its quads into the stream.
+class TextBatch
+{
+public:
+	TextBatch() : _frame(0) { }
+
+	// Positions and letter sizes are in normalized screen units. anchor is the
+	// fraction of the text width left of position: 0 left, 0.5 centered, 1 right.
+	void Add(const char* text, const vec2& position, const vec4& color, const vec2& letter_size, float anchor);
+
+	const std::vector<TextVertex>& vertices() const { return _vertices; }
+
+	// Empties the stream for the next frame, dropping layouts that went unused for a while
+	void Clear();
+
+private:
+	struct Key
+	{
+		std::string text;
+		vec2 letter_size;
+		float anchor;
+
+		bool operator<(const Key& other) const
+		{
+			if (text != other.text)
+				return text < other.text;
+			if (letter_size.x != other.letter_size.x)
+				return letter_size.x < other.letter_size.x;
+			if (letter_size.y != other.letter_size.y)
+				return letter_size.y < other.letter_size.y;
+			return anchor < other.anchor;
+		}
+	};
+
+	struct Run
+	{
+		// Laid out around the origin, color left unset
+		std::vector<TextVertex> vertices;
+		uint lastUsed;
+	};
+
+	static void Layout(const std::string& text, const vec2& letter_size, float anchor, std::vector<TextVertex>& out);
+
+	std::map<Key, Run> _cache;
+	std::vector<TextVertex> _vertices;
+	uint _frame;
+};
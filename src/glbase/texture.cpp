@@ -1,4 +1,5 @@
 #include "texture.h"
+#include "gl_state.h"
 #include <fstream>
 
 Texture::Texture(const char* filepath) : _id(BAD_BUFFER)
@@ -147,7 +148,7 @@ Texture::Texture(const char* filepath) : _id(BAD_BUFFER)
 
 	glGenTextures(1, &_id);
 
-	glBindTexture(GL_TEXTURE_2D, _id);
+	GLState::Instance().BindTexture(0, _id);
 
 	glTexImage2D(GL_TEXTURE_2D, 0, (_depth > 3) ? (GL_RGBA8) : (GL_RGB8), _width, _height, 0, (_depth > 3) ? (GL_RGBA) : (GL_RGB), GL_UNSIGNED_BYTE, &_data[0]);
 
@@ -1,7 +1,10 @@
 #include "tp1.h"
 #include <glm/gtx/string_cast.hpp>
+#include <algorithm>
+#include <cfloat>
 
-CoreTP1::CoreTP1() : Core(), floor(1, vec4(135.0/255, 206.0/255, 250.0/255, 0.75)), f(0), sky(2, vec4(0.0, 0.0, 1.0, 0.5))
+CoreTP1::CoreTP1() : Core(), active_projectiles(-100.0f, 10.0f), floor(1, vec4(135.0/255, 206.0/255, 250.0/255, 0.75), VERTEX_FLOAT), f(0), sky(2, vec4(0.0, 0.0, 1.0, 0.5), VERTEX_FLOAT),
+	fighter_grid({ vec3(-12, -11, -105), vec3(12, 11, 15) }, vec3(4, 4, 5))
 {
 	// Initialize view matrix
 	_viewMatrix = lookAt(vec3(0, 0, 20), vec3(0, 0, 0), vec3(0, 1, 0));
@@ -9,6 +12,24 @@ CoreTP1::CoreTP1() : Core(), floor(1, vec4(135.0/255, 206.0/255, 250.0/255, 0.75
 	// Rescale sky
 	sky.SetTransform(scale(mat4(), vec3(110.0f)));
 
+	capture_impostors();
+}
+
+void CoreTP1::capture_impostors()
+{
+	// One still of each kind, standing at the origin
+	std::unique_ptr<Entity> models[ENTITY_KINDS] = {
+		std::unique_ptr<Entity>(new Fighter1(vec3(0), vec3(0), 0)),
+		std::unique_ptr<Entity>(new Fighter2(vec3(0), vec3(0), 0))
+	};
+
+	for (auto& model : models)
+		model->Update(0);
+
+	TransformHierarchy::Instance().Update();
+
+	for (auto& model : models)
+		CaptureImpostor(model->kind(), model->GetGlobalAABB(), [&model]() { model->Render(); });
 }
 
 void CoreTP1::Render(double dt)
@@ -33,71 +54,57 @@ void CoreTP1::Render(double dt)
 		if (player.input[Player::Input::SPACE] && time - player.last_shot > player.shot_delay)
 		{
 			player.last_shot = time;
-			for (vec3 point : player.getProjectileSpawnPoint())
+
+			vec3 points[MAX_SPAWN_POINTS];
+			uint count = min(player.getProjectileSpawnPoint(points, MAX_SPAWN_POINTS), uint(MAX_SPAWN_POINTS));
+			for (uint i = 0; i < count; ++i)
 			{
-				active_projectiles.push_back(std::make_unique<Projectile>(
-					point, player.projectile_speed,
+				active_projectiles.Spawn(
+					points[i], player.projectile_speed,
 					player.projectile_color_in, player.projectile_color_out,
 					true
-				));
+				);
 			}
 		}
 
-		// Transform and display floor
+		// Transform floor
 		f += float(dt) * 2 * pi<float>() * 0.1f;
 		floor.SetTransform(translate(mat4(), vec3(0.0f, -13.0f, 0.0f)) *scale(mat4(), vec3(100.0f, 1.0f, 100.0f)) * rotate(mat4(), -1.0f * f, vec3(1.0f, 0.0f, 0.0f)));
+
+		// Move projectiles and fighters, projectiles leaving the playfield are dropped
+		active_projectiles.Update(dt);
+
+		for (auto& fighter : active_fighters)
+			fighter->Update(dt);
+
+		// Bring every world transform up to date in a single pass
+		TransformHierarchy::Instance().Update();
+
+		// Display floor
 		floor.Render();
 
 		// Display sky
 		sky.Render();
 
-		// Make the ship winking during the "peaceful period"
-		if (time - start_time > spawn_delay_after_start || time - start_time < 1.0 || time - start_time > 1.5 && time - start_time < 2.0 || time - start_time > 2.5 && time - start_time < 3.0 || time - start_time > 3.5 && time - start_time < 4.0 || time - start_time > 4.5 && time - start_time < 5.0)
-			player.Render();
+		// Entities are tested as a whole before any of their parts is submitted
+		entities_visible = 0;
+		entities_culled = 0;
 
-		bool player_shot = false;
-
-		for (auto proj = active_projectiles.begin(); proj != active_projectiles.end();)
-		{
-			(*proj)->Update(dt);
+		bool player_visible = _frustum.Intersects(player.GetGlobalAABB());
+		if (player_visible)
+			++entities_visible;
+		else
+			++entities_culled;
 
-			bool hit_something = false;
+		// Make the ship winking during the "peaceful period"
+		if (player_visible && (time - start_time > spawn_delay_after_start || time - start_time < 1.0 || time - start_time > 1.5 && time - start_time < 2.0 || time - start_time > 2.5 && time - start_time < 3.0 || time - start_time > 3.5 && time - start_time < 4.0 || time - start_time > 4.5 && time - start_time < 5.0))
+			player.Render();
 
-			// If the projectile we consider comes from an enemy
-			if (!(*proj)->friendly())
-			{
-				hit_something = player.Intersect((*proj)->position());
-				player_shot |= hit_something;
-			}
-			// If the projectile we consider comes from the player
-			else
-			{
-				for (auto fighter = active_fighters.begin(); fighter != active_fighters.end();)
-				{
-					if ((*fighter)->Intersect((*proj)->position()))
-					{
-						hit_something = true;
-						player.score += (*fighter)->score;
-						fighter = active_fighters.erase(fighter);
-					}
-					else
-					{
-					    ++fighter;
-					}
-				}
-			}
+		// Find and remove whatever was hit this frame
+		bool player_shot = collide_projectiles();
 
-			// If the projectile has hit something
-			if (hit_something)
-			{
-				proj = active_projectiles.erase(proj);
-			}
-			else
-			{
-				(*proj)->Render();
-				++proj;
-			}
-		}
+		projectiles_visible = active_projectiles.Render(_frustum);
+		projectiles_culled = active_projectiles.size() - projectiles_visible;
 
 		// If the player has been shot
 		if (player_shot)
@@ -105,34 +112,87 @@ void CoreTP1::Render(double dt)
 			player_hit();
 		}
 
-		for (auto fighter = active_fighters.begin(); fighter != active_fighters.end(); ++fighter)
+		for (uint& count : fighters_per_lod)
+			count = 0;
+
+		for (auto& fighter : active_fighters)
 		{
-			(*fighter)->Update(dt);
-			(*fighter)->Render();
+			AABB bounds = fighter->GetGlobalAABB();
+			if (!_frustum.Intersects(bounds))
+			{
+				++entities_culled;
+				continue;
+			}
+
+			++entities_visible;
+
+			// Tessellation follows the size on screen, far away a captured still is enough
+			fighter->SetLod(SelectLod(fighter->GetLod(), ProjectedSize(bounds, _viewMatrix, _projectionMatrix, float(_height))));
+			++fighters_per_lod[fighter->GetLod()];
+
+			if (fighter->GetLod() == LOD_IMPOSTOR)
+				SubmitImpostor(fighter->kind(), bounds);
+			else
+				fighter->Render();
 		}
 
 
 		if (display_aabb)
 		{
-			// Clear AABB lines buffer
-			_lineVertices.clear();
+			// Queued for this frame only, drawn in a few batches after the scene
+			const ddVec3 global_color = { 1.0f, 1.0f, 0.0f };
+			const ddVec3 part_color = { 0.0f, 1.0f, 1.0f };
+			const ddVec3 friendly_color = { 0.0f, 1.0f, 0.0f };
+			const ddVec3 enemy_color = { 1.0f, 0.0f, 0.0f };
+
+			::AABB boxes[MAX_PARTS];
 
-			// Fill AABB lines for player
+			// Player boxes
 			auto globalAABB = player.GetGlobalAABB();
-			AABB(globalAABB.min, globalAABB.max);
-			for (auto box : player.GetAABB())
-				AABB(box.min, box.max);
+			dd::aabb(value_ptr(globalAABB.min), value_ptr(globalAABB.max), global_color);
+			uint count = min(player.GetAABB(boxes, MAX_PARTS), uint(MAX_PARTS));
+			for (uint i = 0; i < count; ++i)
+				dd::aabb(value_ptr(boxes[i].min), value_ptr(boxes[i].max), part_color);
 
-			// Fill AABB lines for fighters
+			// Fighter boxes
 			for (auto& fighter : active_fighters)
 			{
 				auto globalAABB = fighter->GetGlobalAABB();
-				AABB(globalAABB.min, globalAABB.max);
-				for (auto box : fighter->GetAABB())
-					AABB(box.min, box.max);
+				dd::aabb(value_ptr(globalAABB.min), value_ptr(globalAABB.max), global_color);
+				count = min(fighter->GetAABB(boxes, MAX_PARTS), uint(MAX_PARTS));
+				for (uint i = 0; i < count; ++i)
+					dd::aabb(value_ptr(boxes[i].min), value_ptr(boxes[i].max), part_color);
 			}
 
-			DrawAABBs();
+			// Projectiles, colored by side; past the point budget the rest go unmarked
+			uint markers = min(active_projectiles.size(), uint(DEBUG_DRAW_MAX_POINTS));
+			for (uint i = 0; i < markers; ++i)
+			{
+				vec3 position = active_projectiles.position(i);
+				dd::point(value_ptr(position), active_projectiles.friendly(i) ? friendly_color : enemy_color, 4.0f);
+			}
+
+			// Broad phase efficiency for player projectiles
+			DrawText((std::string("Paires testees: ") + std::to_string(pairs_tested) +
+				" eliminees: " + std::to_string(pairs_culled)).c_str(), vec2(0.01, 0.95), vec4(1), 16U, ALIGN_LEFT);
+
+			DrawText((std::string("Appels de dessin: ") + std::to_string(RenderQueue::Instance().draw_calls()) +
+				" debug: " + std::to_string(_debugDraw.draw_calls())).c_str(), vec2(0.01, 0.90), vec4(1), 16U, ALIGN_LEFT);
+
+			// Counted over the previous frame, the current one is still in progress
+			DrawText((std::string("Appels GL: ") + std::to_string(GLState::Instance().issued()) +
+				" evites: " + std::to_string(GLState::Instance().elided())).c_str(), vec2(0.01, 0.85), vec4(1), 16U, ALIGN_LEFT);
+
+			DrawText((std::string("Visibles: ") + std::to_string(entities_visible) + " / " + std::to_string(projectiles_visible) +
+				" hors champ: " + std::to_string(entities_culled) + " / " + std::to_string(projectiles_culled)).c_str(), vec2(0.01, 0.80), vec4(1), 16U, ALIGN_LEFT);
+
+			std::string lods = "Niveaux de detail:";
+			for (uint count : fighters_per_lod)
+				lods += " " + std::to_string(count);
+			DrawText(lods.c_str(), vec2(0.01, 0.75), vec4(1), 16U, ALIGN_LEFT);
+
+			DrawText((std::string("Sommets: ") + std::to_string(RenderQueue::Instance().vertices()) +
+				" imposteurs: " + std::to_string(_impostors.count())).c_str(), vec2(0.01, 0.70), vec4(1), 16U, ALIGN_LEFT);
 		}
 
 
@@ -220,14 +280,33 @@ void CoreTP1::OnKeyTAB(bool down)
 
 void CoreTP1::DrawEndGameText(int score)
 {
+	UpdateHUDText(player.lifes, score);
+
 	DrawText("Fin de partie!", vec2(0.5, 0.6), vec4(1), 32U, ALIGN_CENTER);
-	DrawText((std::string("Pointage: ") + std::to_string(score)).c_str(), vec2(0.5, 0.5), vec4(1), 32U, ALIGN_CENTER);
+	DrawText(hud_score_text.c_str(), vec2(0.5, 0.5), vec4(1), 32U, ALIGN_CENTER);
 }
 
 void CoreTP1::DrawGameText(int lives, int score)
 {
-	DrawText((std::string("Vies: ") + std::to_string(lives)).c_str(), vec2(0.99, 0.01), vec4(1), 16U, ALIGN_RIGHT);
-	DrawText((std::string("Pointage: ") + std::to_string(score)).c_str(), vec2(0.01, 0.01), vec4(1), 16U, ALIGN_LEFT);
+	UpdateHUDText(lives, score);
+
+	DrawText(hud_lives_text.c_str(), vec2(0.99, 0.01), vec4(1), 16U, ALIGN_RIGHT);
+	DrawText(hud_score_text.c_str(), vec2(0.01, 0.01), vec4(1), 16U, ALIGN_LEFT);
+}
+
+void CoreTP1::UpdateHUDText(int lives, int score)
+{
+	if (lives != hud_lives)
+	{
+		hud_lives = lives;
+		hud_lives_text = std::string("Vies: ") + std::to_string(lives);
+	}
+
+	if (score != hud_score)
+	{
+		hud_score = score;
+		hud_score_text = std::string("Pointage: ") + std::to_string(score);
+	}
 }
 
 void CoreTP1::spawn_enemies()
@@ -240,7 +319,7 @@ void CoreTP1::spawn_enemies()
 		vec3 spawn = vec3(rand() % 17 - 8, rand() % 15 - 7, -100);
 		if (rand() % 100 < 75)
 		{
-			active_fighters.push_back(std::make_unique<Fighter1>(
+			active_fighters.Insert(std::make_unique<Fighter1>(
 				spawn, vec3(0, 0, 2.5), 2,
 				vec3((rand() % 2 ? 1 : -1) * rand() % 2,
 					(rand() % 2 ? 1 : -1) * rand() % 2, 5)
@@ -248,7 +327,7 @@ void CoreTP1::spawn_enemies()
 		}
 		else
 		{
-			active_fighters.push_back(std::make_unique<Fighter2>(
+			active_fighters.Insert(std::make_unique<Fighter2>(
 				spawn, vec3(0, 0, 5), 2, vec3(0, 0, 10)
 			));
 		}
@@ -263,38 +342,145 @@ void CoreTP1::fire_enemies()
 		if (time - fighter->last_shot > fighter->rof)
 		{
 			fighter->last_shot = time;
-			for (vec3 point : fighter->GetProjectileSpawnPoint())
+
+			vec3 points[MAX_SPAWN_POINTS];
+			uint count = min(fighter->GetProjectileSpawnPoint(points, MAX_SPAWN_POINTS), uint(MAX_SPAWN_POINTS));
+			for (uint i = 0; i < count; ++i)
 			{
-				active_projectiles.push_back(std::make_unique<Projectile>(
-					point, fighter->projectile_vel,
+				active_projectiles.Spawn(
+					points[i], fighter->projectile_vel,
 					vec4(.0, .0, .7, 1.), vec4(.0, .0, .7, .8),
 					false
-				));
+				);
 			}
 		}
 	}
 }
 
-void CoreTP1::clean_scene()
+bool CoreTP1::collide_projectiles()
 {
-	for (auto proj = active_projectiles.begin(); proj != active_projectiles.end();)
+	bool player_shot = false;
+	projectile_hit.assign(active_projectiles.size(), 0);
+
+	// Projectiles are swept over the distance they travelled this frame, so fast
+	// shots cannot tunnel through thin parts between two updates
+
+	// Enemy shots are tested against the player in a single batch
+	shots.Clear();
+	shot_ids.clear();
+	for (uint i = 0; i < active_projectiles.size(); ++i)
 	{
-		if ((*proj)->position().z > 10 || (*proj)->position().z < -100)
-			proj = active_projectiles.erase(proj);
-		else
-			++proj;
+		if (!active_projectiles.friendly(i))
+		{
+			shots.Add(active_projectiles.previous(i), active_projectiles.position(i));
+			shot_ids.push_back(i);
+		}
 	}
 
-	for (auto fighter = active_fighters.begin(); fighter != active_fighters.end();)
+	player.IntersectSegments(shots, shot_toi);
+	for (uint s = 0; s < shots.size(); ++s)
 	{
-		if ((*fighter)->Position.z > 5)
+		if (shot_toi[s] != FLT_MAX)
 		{
-			player.score -= (*fighter)->score;
-			fighter = active_fighters.erase(fighter);
+			projectile_hit[shot_ids[s]] = 1;
+			player_shot = true;
 		}
-		else
+	}
+
+	// Bucket fighters so each player shot is only paired with nearby ones
+	fighter_grid.Clear();
+	for (uint i = 0; i < active_fighters.size(); ++i)
+		fighter_grid.Insert(i, active_fighters[i]->GetGlobalAABB());
+	fighter_grid.Build();
+
+	shot_pairs.clear();
+	uint friendly_count = 0;
+	for (uint i = 0; i < active_projectiles.size(); ++i)
+	{
+		if (!active_projectiles.friendly(i))
+			continue;
+
+		++friendly_count;
+		vec3 from = active_projectiles.previous(i), to = active_projectiles.position(i);
+		for (uint id : fighter_grid.Query({ min(from, to), max(from, to) }))
+			shot_pairs.push_back({ id, i, 0.0f });
+	}
+
+	pairs_tested = shot_pairs.size();
+	pairs_culled = friendly_count * active_fighters.size() - pairs_tested;
+
+	// Each fighter tests all of its candidate shots in one batch
+	std::sort(shot_pairs.begin(), shot_pairs.end(), [](const ShotPair& a, const ShotPair& b)
+	{
+		return a.fighter < b.fighter || (a.fighter == b.fighter && a.projectile < b.projectile);
+	});
+
+	shot_hits.clear();
+	for (uint begin = 0, end = 0; begin < shot_pairs.size(); begin = end)
+	{
+		uint fighter = shot_pairs[begin].fighter;
+
+		shots.Clear();
+		for (end = begin; end < shot_pairs.size() && shot_pairs[end].fighter == fighter; ++end)
+		{
+			uint proj = shot_pairs[end].projectile;
+			shots.Add(active_projectiles.previous(proj), active_projectiles.position(proj));
+		}
+
+		active_fighters[fighter]->IntersectSegments(shots, shot_toi);
+		for (uint k = begin; k < end; ++k)
+		{
+			if (shot_toi[k - begin] != FLT_MAX)
+			{
+				shot_pairs[k].toi = shot_toi[k - begin];
+				shot_hits.push_back(shot_pairs[k]);
+			}
+		}
+	}
+
+	// In projectile order, each shot destroys the first fighter still alive along its path
+	std::sort(shot_hits.begin(), shot_hits.end(), [](const ShotPair& a, const ShotPair& b)
+	{
+		return a.projectile < b.projectile || (a.projectile == b.projectile && a.toi < b.toi);
+	});
+
+	fighter_hit.assign(active_fighters.size(), 0);
+	for (const ShotPair& hit : shot_hits)
+	{
+		if (projectile_hit[hit.projectile] || fighter_hit[hit.fighter])
+			continue;
+
+		projectile_hit[hit.projectile] = 1;
+		fighter_hit[hit.fighter] = 1;
+		player.score += active_fighters[hit.fighter]->score;
+	}
+
+	// Remove the fighters and projectiles that were hit. Fighter positions shift as
+	// values are swapped out, so their removal goes through stable handles.
+	dead_fighters.clear();
+	for (uint i = 0; i < active_fighters.size(); ++i)
+	{
+		if (fighter_hit[i])
+			dead_fighters.push_back(active_fighters.HandleAt(i));
+	}
+	for (auto handle : dead_fighters)
+		active_fighters.Remove(handle);
+
+	active_projectiles.Remove(projectile_hit);
+
+	return player_shot;
+}
+
+void CoreTP1::clean_scene()
+{
+	// Projectiles out of the playfield are dropped by ProjectileSystem::Update.
+	// Walking backwards, the value swapped into a removed position was already checked.
+	for (uint i = active_fighters.size(); i-- > 0;)
+	{
+		if (active_fighters[i]->Position.z > 5)
 		{
-			++fighter;
+			player.score -= active_fighters[i]->score;
+			active_fighters.RemoveAt(i);
 		}
 	}
 }
@@ -312,8 +498,8 @@ void CoreTP1::player_hit()
 	{
 		start_time = glfwGetTime();
 
-		active_fighters.clear();
-		active_projectiles.clear();
+		active_fighters.Clear();
+		active_projectiles.Clear();
 
 		player.Position = vec3(0);
 		if (--player.lifes == 0)
@@ -2,6 +2,12 @@
 #include "core.h"
 #include "scene.h"
 #include "player.h"
+#include "grid.h"
+#include "slot_map.h"
+#include "projectiles.h"
+#include "render_queue.h"
+#include "gl_state.h"
+#include "lod.h"
 
 class CoreTP1 : public Core
 {
@@ -20,13 +26,16 @@ protected:
 	virtual void OnKeyTAB(bool down) override;
 	void DrawEndGameText(int score);
 	void DrawGameText(int lives, int score);
+	void UpdateHUDText(int lives, int score);
 
 	void spawn_enemies();
 	void fire_enemies();
 	void clean_scene();
+	bool collide_projectiles();
+	void capture_impostors();
 
-	std::vector<std::unique_ptr<Projectile>> active_projectiles;
-	std::vector<std::unique_ptr<Entity>> active_fighters;
+	ProjectileSystem active_projectiles;
+	SlotMap<std::unique_ptr<Entity>> active_fighters;
 
 protected:
 	Player player;
@@ -46,4 +55,38 @@ protected:
 	double spawn_delay = 3.0;
 
 	double last_spawn = 0.0;
+
+	// HUD strings, only rebuilt when their value changes
+	int hud_lives = -1;
+	int hud_score = INT_MIN;
+	std::string hud_lives_text, hud_score_text;
+
+	// Projectile vs fighter broad phase
+	UniformGrid fighter_grid;
+	uint pairs_tested = 0;
+	uint pairs_culled = 0;
+
+	// View frustum culling of this frame
+	uint entities_visible = 0;
+	uint entities_culled = 0;
+	uint projectiles_visible = 0;
+	uint projectiles_culled = 0;
+
+	// Fighters drawn at each tessellation level, the last one counting impostors
+	uint fighters_per_lod[LOD_IMPOSTOR + 1] = {};
+
+	// Narrow phase scratch, kept between frames to avoid allocations
+	struct ShotPair
+	{
+		uint fighter;
+		uint projectile;
+		float toi;
+	};
+
+	SegmentBatch shots;
+	std::vector<uint> shot_ids;
+	std::vector<float> shot_toi;
+	std::vector<ShotPair> shot_pairs, shot_hits;
+	std::vector<unsigned char> fighter_hit, projectile_hit;
+	std::vector<SlotMap<std::unique_ptr<Entity>>::Handle> dead_fighters;
 };
\ No newline at end of file